@@ -0,0 +1,55 @@
+#include "Engine/Core/BufferBitParser.hpp"
+
+#include "Engine/Core/BufferEncoding.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+BufferBitParser::BufferBitParser(BufferParser& bufferParser)
+	: m_bufferParser(bufferParser)
+{
+}
+
+//! Parses numBits bits, from 1 to 32, appended with BufferBitWriter::AppendBits
+uint32_t BufferBitParser::ParseBits(int numBits)
+{
+	GUARANTEE_OR_DIE(numBits >= 1 && numBits <= 32, "Can only parse between 1 and 32 bits at a time");
+
+	while (m_numAvailableBits < numBits)
+	{
+		m_availableBits |= static_cast<uint64_t>(m_bufferParser.ParseByte()) << m_numAvailableBits;
+		m_numAvailableBits += 8;
+	}
+
+	uint64_t bitMask = (1ull << numBits) - 1;
+	uint32_t result = static_cast<uint32_t>(m_availableBits & bitMask);
+	m_availableBits >>= numBits;
+	m_numAvailableBits -= numBits;
+	return result;
+}
+
+bool BufferBitParser::ParseBool()
+{
+	return ParseBits(1) != 0;
+}
+
+//! Parses a float appended with BufferBitWriter::AppendQuantizedFloat with the same range and number of bits
+float BufferBitParser::ParseQuantizedFloat(float minValue, float maxValue, int numBits)
+{
+	return DequantizeFloat(ParseBits(numBits), minValue, maxValue, numBits);
+}
+
+Vec3 const BufferBitParser::ParseQuantizedVec3(Vec3 const& minValues, Vec3 const& maxValues, int numBits)
+{
+	Vec3 result;
+	result.x = ParseQuantizedFloat(minValues.x, maxValues.x, numBits);
+	result.y = ParseQuantizedFloat(minValues.y, maxValues.y, numBits);
+	result.z = ParseQuantizedFloat(minValues.z, maxValues.z, numBits);
+	return result;
+}
+
+//! Discards the padding bits of the current byte, so the next bits are parsed from the start of the next byte
+void BufferBitParser::AlignToByte()
+{
+	m_availableBits = 0;
+	m_numAvailableBits = 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <cstdint>
+
+
+/*! \brief Parses values packed by a BufferBitWriter from the bytes of a BufferParser
+* 
+* Bytes are parsed from the BufferParser only when their bits are needed. AlignToByte discards the rest of the current byte, matching BufferBitWriter::Flush, after which the BufferParser can be used directly again.
+* 
+*/
+class BufferBitParser
+{
+public:
+	BufferBitParser(BufferParser& bufferParser);
+	BufferBitParser(BufferBitParser const& copyFrom) = delete;
+	BufferBitParser& operator=(BufferBitParser const& assignFrom) = delete;
+
+	uint32_t ParseBits(int numBits);
+	bool ParseBool();
+	float ParseQuantizedFloat(float minValue, float maxValue, int numBits);
+	Vec3 const ParseQuantizedVec3(Vec3 const& minValues, Vec3 const& maxValues, int numBits);
+
+	void AlignToByte();
+
+private:
+	BufferParser& m_bufferParser;
+	uint64_t m_availableBits = 0;
+	int m_numAvailableBits = 0;
+};
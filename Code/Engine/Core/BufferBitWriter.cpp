@@ -0,0 +1,68 @@
+#include "Engine/Core/BufferBitWriter.hpp"
+
+#include "Engine/Core/BufferEncoding.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+BufferBitWriter::BufferBitWriter(BufferWriter& bufferWriter)
+	: m_bufferWriter(bufferWriter)
+{
+}
+
+BufferBitWriter::~BufferBitWriter()
+{
+	Flush();
+}
+
+/*! \brief Appends the low numBits bits of a value
+* 
+* \param bitsToAppend The value to append, bits above the low numBits are ignored
+* \param numBits The number of bits to append, from 1 to 32
+* 
+*/
+void BufferBitWriter::AppendBits(uint32_t bitsToAppend, int numBits)
+{
+	GUARANTEE_OR_DIE(numBits >= 1 && numBits <= 32, "Can only append between 1 and 32 bits at a time");
+
+	// Fewer than 8 bits are ever pending between calls, so up to 39 bits fit in the 64-bit accumulator
+	uint64_t bitMask = (1ull << numBits) - 1;
+	m_pendingBits |= (static_cast<uint64_t>(bitsToAppend) & bitMask) << m_numPendingBits;
+	m_numPendingBits += numBits;
+
+	while (m_numPendingBits >= 8)
+	{
+		m_bufferWriter.AppendByte(static_cast<uint8_t>(m_pendingBits));
+		m_pendingBits >>= 8;
+		m_numPendingBits -= 8;
+	}
+}
+
+void BufferBitWriter::AppendBool(bool boolToAppend)
+{
+	AppendBits(boolToAppend ? 1 : 0, 1);
+}
+
+//! Appends a float in a known range quantized to exactly numBits bits \sa QuantizeFloat
+void BufferBitWriter::AppendQuantizedFloat(float floatToAppend, float minValue, float maxValue, int numBits)
+{
+	AppendBits(QuantizeFloat(floatToAppend, minValue, maxValue, numBits), numBits);
+}
+
+void BufferBitWriter::AppendQuantizedVec3(Vec3 const& vec3ToAppend, Vec3 const& minValues, Vec3 const& maxValues, int numBits)
+{
+	AppendQuantizedFloat(vec3ToAppend.x, minValues.x, maxValues.x, numBits);
+	AppendQuantizedFloat(vec3ToAppend.y, minValues.y, maxValues.y, numBits);
+	AppendQuantizedFloat(vec3ToAppend.z, minValues.z, maxValues.z, numBits);
+}
+
+//! Appends the last partial byte padded with zeros, after which the BufferWriter can be used directly again
+void BufferBitWriter::Flush()
+{
+	if (m_numPendingBits > 0)
+	{
+		m_bufferWriter.AppendByte(static_cast<uint8_t>(m_pendingBits));
+	}
+
+	m_pendingBits = 0;
+	m_numPendingBits = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <cstdint>
+
+
+/*! \brief Packs values that need fewer than 8 bits, such as flags and quantized floats, into the bytes of a BufferWriter
+* 
+* Bits are packed starting with the least significant bit of each byte, so the packed bytes are the same in every endian mode. Whole bytes are appended to the BufferWriter as soon as they are filled, and the last partial byte is appended, padded with zeros, by Flush or when the bit writer is destroyed. The BufferWriter must not be used directly until the bit writer has been flushed.
+* 
+*/
+class BufferBitWriter
+{
+public:
+	BufferBitWriter(BufferWriter& bufferWriter);
+	~BufferBitWriter();
+	BufferBitWriter(BufferBitWriter const& copyFrom) = delete;
+	BufferBitWriter& operator=(BufferBitWriter const& assignFrom) = delete;
+
+	void AppendBits(uint32_t bitsToAppend, int numBits);
+	void AppendBool(bool boolToAppend);
+	void AppendQuantizedFloat(float floatToAppend, float minValue, float maxValue, int numBits);
+	void AppendQuantizedVec3(Vec3 const& vec3ToAppend, Vec3 const& minValues, Vec3 const& maxValues, int numBits);
+
+	void Flush();
+
+	int GetNumPendingBits() const { return m_numPendingBits; }
+
+private:
+	BufferWriter& m_bufferWriter;
+	uint64_t m_pendingBits = 0;
+	int m_numPendingBits = 0;
+};
@@ -0,0 +1,514 @@
+#include "Engine/Core/BufferCompression.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+
+/* Compressed buffers start with a header of the fourCC "RZ4B", a version byte and the block size as a uint32_t. Each block follows as its uncompressed size and stored size as uint32_ts and then the stored bytes, and a block with an uncompressed size of 0 ends the compressed data. Blocks whose stored size equals their uncompressed size are stored without compression. Everything is little-endian.
+* Blocks use the LZ4 block format: sequences of a token (literal length in the high 4 bits, match length - 4 in the low 4 bits, 15 meaning more length bytes follow), the literals, and a 2-byte little-endian match offset, with the last sequence holding only literals.
+*/
+static constexpr uint8_t COMPRESSED_BUFFER_FOURCC[4] = { 'R', 'Z', '4', 'B' };
+static constexpr uint8_t COMPRESSED_BUFFER_VERSION = 1;
+static constexpr size_t COMPRESSED_BUFFER_HEADER_SIZE = 4 + 1 + 4;
+static constexpr size_t COMPRESSED_BLOCK_HEADER_SIZE = 4 + 4;
+
+static constexpr int COMPRESSION_HASH_BITS = 12;
+static constexpr int COMPRESSION_MIN_MATCH_LENGTH = 4;
+static constexpr size_t COMPRESSION_MAX_MATCH_OFFSET = 65535;
+// As in LZ4, the last 5 bytes are always literals and no match starts in the last 12 bytes, so the decompressor can copy ahead safely
+static constexpr size_t COMPRESSION_NUM_LAST_LITERALS = 5;
+static constexpr size_t COMPRESSION_MATCH_SEARCH_END_DISTANCE = 12;
+// A block cannot decompress to more than 255 bytes per stored byte, since every length byte of 255 adds 255 bytes and every other byte adds fewer
+static constexpr size_t COMPRESSION_MAX_EXPANSION_RATIO = 255;
+static constexpr size_t COMPRESSION_MAX_EXPANSION_SLACK = 16;
+// Every 64 positions without a match, the search skips one more position per step so incompressible data is passed over quickly
+static constexpr int COMPRESSION_SKIP_TRIGGER_BITS = 6;
+
+
+static uint32_t ReadUint32Unaligned(uint8_t const* bytes)
+{
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(uint32_t));
+	return value;
+}
+
+static uint64_t ReadUint64Unaligned(uint8_t const* bytes)
+{
+	uint64_t value;
+	memcpy(&value, bytes, sizeof(uint64_t));
+	return value;
+}
+
+static uint32_t GetCompressionHash(uint32_t fourBytes)
+{
+	return (fourBytes * 2654435761u) >> (32 - COMPRESSION_HASH_BITS);
+}
+
+// Appends a length that did not fit in the 4 bits of the token as bytes of 255 followed by the remainder
+static uint8_t* WriteExtendedLength(uint8_t* out_bytes, size_t length)
+{
+	while (length >= 255)
+	{
+		*out_bytes++ = 255;
+		length -= 255;
+	}
+	*out_bytes++ = static_cast<uint8_t>(length);
+	return out_bytes;
+}
+
+static uint8_t* WriteSequence(uint8_t* out_bytes, uint8_t const* literals, size_t numLiterals, size_t matchOffset, size_t matchLength)
+{
+	uint8_t* token = out_bytes++;
+	*token = 0;
+
+	if (numLiterals >= 15)
+	{
+		*token = 15 << 4;
+		out_bytes = WriteExtendedLength(out_bytes, numLiterals - 15);
+	}
+	else
+	{
+		*token = static_cast<uint8_t>(numLiterals << 4);
+	}
+	memcpy(out_bytes, literals, numLiterals);
+	out_bytes += numLiterals;
+
+	// The last sequence has only literals
+	if (matchLength == 0)
+	{
+		return out_bytes;
+	}
+
+	*out_bytes++ = static_cast<uint8_t>(matchOffset);
+	*out_bytes++ = static_cast<uint8_t>(matchOffset >> 8);
+
+	size_t encodedMatchLength = matchLength - COMPRESSION_MIN_MATCH_LENGTH;
+	if (encodedMatchLength >= 15)
+	{
+		*token |= 15;
+		out_bytes = WriteExtendedLength(out_bytes, encodedMatchLength - 15);
+	}
+	else
+	{
+		*token |= static_cast<uint8_t>(encodedMatchLength);
+	}
+	return out_bytes;
+}
+
+// Reads the extra bytes of a length whose 4 bits in the token were all set, returns false if the length runs past the end of the compressed bytes
+static bool ReadExtendedLength(uint8_t const*& compressedBytes, uint8_t const* compressedBytesEnd, size_t& out_length)
+{
+	uint8_t lengthByte = 255;
+	while (lengthByte == 255)
+	{
+		if (compressedBytes >= compressedBytesEnd)
+		{
+			return false;
+		}
+		lengthByte = *compressedBytes++;
+		out_length += lengthByte;
+	}
+	return true;
+}
+
+
+//! Returns the number of bytes CompressBlock may need to compress numBytes bytes, which is slightly more than numBytes for incompressible data
+size_t GetMaxCompressedBlockSize(size_t numBytes)
+{
+	return numBytes + numBytes / 255 + 16;
+}
+
+/*! \brief Compresses a block of bytes with a fast LZ4-style codec
+*
+* Repeated sequences of 4 or more bytes up to 64KB back are found with a hash table of recent positions and replaced with a reference to the earlier copy. The compression is greedy, favoring speed over ratio.
+* \param sourceBytes The bytes to compress
+* \param numSourceBytes The number of bytes to compress
+* \param out_compressedBytes Where the compressed bytes are written
+* \param compressedBytesCapacity The space available in out_compressedBytes, must be at least GetMaxCompressedBlockSize(numSourceBytes)
+* \return The number of compressed bytes written, which can be larger than numSourceBytes for incompressible data
+*
+*/
+size_t CompressBlock(uint8_t const* sourceBytes, size_t numSourceBytes, uint8_t* out_compressedBytes, size_t compressedBytesCapacity)
+{
+	GUARANTEE_OR_DIE(compressedBytesCapacity >= GetMaxCompressedBlockSize(numSourceBytes), "Not enough space to compress block");
+
+	uint8_t* compressedBytes = out_compressedBytes;
+	size_t literalsStartIndex = 0;
+
+	if (numSourceBytes > COMPRESSION_MATCH_SEARCH_END_DISTANCE)
+	{
+		uint32_t recentPositionsByHash[1 << COMPRESSION_HASH_BITS] = {};
+		size_t matchSearchEndIndex = numSourceBytes - COMPRESSION_MATCH_SEARCH_END_DISTANCE;
+		size_t matchExtendEndIndex = numSourceBytes - COMPRESSION_NUM_LAST_LITERALS;
+		size_t sourceIndex = 1;
+		size_t numAttemptsWithoutMatch = 0;
+
+		while (sourceIndex < matchSearchEndIndex)
+		{
+			uint32_t fourBytes = ReadUint32Unaligned(sourceBytes + sourceIndex);
+			uint32_t hash = GetCompressionHash(fourBytes);
+			size_t candidateIndex = recentPositionsByHash[hash];
+			recentPositionsByHash[hash] = static_cast<uint32_t>(sourceIndex);
+
+			if (sourceIndex - candidateIndex > COMPRESSION_MAX_MATCH_OFFSET || ReadUint32Unaligned(sourceBytes + candidateIndex) != fourBytes)
+			{
+				sourceIndex += 1 + (numAttemptsWithoutMatch++ >> COMPRESSION_SKIP_TRIGGER_BITS);
+				continue;
+			}
+			numAttemptsWithoutMatch = 0;
+
+			// Extend the match backwards into the pending literals, then forwards 8 bytes at a time
+			while (sourceIndex > literalsStartIndex && candidateIndex > 0 && sourceBytes[sourceIndex - 1] == sourceBytes[candidateIndex - 1])
+			{
+				sourceIndex--;
+				candidateIndex--;
+			}
+
+			size_t matchLength = COMPRESSION_MIN_MATCH_LENGTH;
+			while (sourceIndex + matchLength + 8 <= matchExtendEndIndex && ReadUint64Unaligned(sourceBytes + sourceIndex + matchLength) == ReadUint64Unaligned(sourceBytes + candidateIndex + matchLength))
+			{
+				matchLength += 8;
+			}
+			while (sourceIndex + matchLength < matchExtendEndIndex && sourceBytes[sourceIndex + matchLength] == sourceBytes[candidateIndex + matchLength])
+			{
+				matchLength++;
+			}
+
+			compressedBytes = WriteSequence(compressedBytes, sourceBytes + literalsStartIndex, sourceIndex - literalsStartIndex, sourceIndex - candidateIndex, matchLength);
+			sourceIndex += matchLength;
+			literalsStartIndex = sourceIndex;
+
+			// Remember a position inside the match so that the next repeat of this data is found
+			if (sourceIndex < matchSearchEndIndex)
+			{
+				recentPositionsByHash[GetCompressionHash(ReadUint32Unaligned(sourceBytes + sourceIndex - 2))] = static_cast<uint32_t>(sourceIndex - 2);
+			}
+		}
+	}
+
+	compressedBytes = WriteSequence(compressedBytes, sourceBytes + literalsStartIndex, numSourceBytes - literalsStartIndex, 0, 0);
+	return static_cast<size_t>(compressedBytes - out_compressedBytes);
+}
+
+/*! \brief Decompresses a block compressed with CompressBlock
+*
+* Every length and offset is checked, so corrupted data makes this return false instead of reading or writing out of bounds.
+* \param compressedBytes The compressed bytes
+* \param numCompressedBytes The number of compressed bytes
+* \param out_bytes Where the decompressed bytes are written
+* \param numBytes The size of the block before it was compressed
+* \return Whether the block decompressed to exactly numBytes bytes
+*
+*/
+bool DecompressBlock(uint8_t const* compressedBytes, size_t numCompressedBytes, uint8_t* out_bytes, size_t numBytes)
+{
+	uint8_t const* compressedBytesEnd = compressedBytes + numCompressedBytes;
+	uint8_t* bytes = out_bytes;
+	uint8_t* bytesEnd = out_bytes + numBytes;
+
+	while (compressedBytes < compressedBytesEnd)
+	{
+		uint8_t token = *compressedBytes++;
+
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15 && !ReadExtendedLength(compressedBytes, compressedBytesEnd, numLiterals))
+		{
+			return false;
+		}
+		if (numLiterals > static_cast<size_t>(compressedBytesEnd - compressedBytes) || numLiterals > static_cast<size_t>(bytesEnd - bytes))
+		{
+			return false;
+		}
+		memcpy(bytes, compressedBytes, numLiterals);
+		compressedBytes += numLiterals;
+		bytes += numLiterals;
+
+		if (compressedBytes == compressedBytesEnd)
+		{
+			break;
+		}
+
+		if (compressedBytesEnd - compressedBytes < 2)
+		{
+			return false;
+		}
+		size_t matchOffset = static_cast<size_t>(compressedBytes[0]) | (static_cast<size_t>(compressedBytes[1]) << 8);
+		compressedBytes += 2;
+		if (matchOffset == 0 || matchOffset > static_cast<size_t>(bytes - out_bytes))
+		{
+			return false;
+		}
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadExtendedLength(compressedBytes, compressedBytesEnd, matchLength))
+		{
+			return false;
+		}
+		matchLength += COMPRESSION_MIN_MATCH_LENGTH;
+		if (matchLength > static_cast<size_t>(bytesEnd - bytes))
+		{
+			return false;
+		}
+
+		// Matches can overlap the bytes they produce (an offset of 1 repeats a single byte), so they are only copied in 8 byte chunks when the chunks cannot overlap
+		uint8_t const* matchBytes = bytes - matchOffset;
+		size_t numCopiedBytes = 0;
+		if (matchOffset >= 8)
+		{
+			for (; numCopiedBytes + 8 <= matchLength; numCopiedBytes += 8)
+			{
+				memcpy(bytes + numCopiedBytes, matchBytes + numCopiedBytes, 8);
+			}
+		}
+		for (; numCopiedBytes < matchLength; numCopiedBytes++)
+		{
+			bytes[numCopiedBytes] = matchBytes[numCopiedBytes];
+		}
+		bytes += matchLength;
+	}
+
+	return bytes == bytesEnd;
+}
+
+//! Returns whether a buffer starts with the header written by CompressedBufferWriter
+bool IsCompressedBuffer(uint8_t const* bufferData, size_t bufferSize)
+{
+	return bufferSize >= COMPRESSED_BUFFER_HEADER_SIZE && memcmp(bufferData, COMPRESSED_BUFFER_FOURCC, 4) == 0 && bufferData[4] == COMPRESSED_BUFFER_VERSION;
+}
+
+/*! \brief Decompresses the output of a CompressedBufferWriter
+*
+* The block headers are read first to find where every block goes, then the blocks are decompressed straight into out_buffer, in parallel when a JobSystem is given.
+* \param out_buffer The buffer the decompressed bytes are appended to, it is left unchanged if decompression fails
+* \param compressedData The compressed data, starting with its header
+* \param compressedSize The number of bytes of compressed data. Bytes after the end of the compressed data are ignored
+* \param jobSystem The JobSystem whose workers should decompress the blocks, or nullptr to decompress them on the calling thread
+* \return Whether the compressed data was complete and valid
+*
+*/
+bool DecompressBuffer(std::vector<uint8_t>& out_buffer, uint8_t const* compressedData, size_t compressedSize, JobSystem* jobSystem)
+{
+	if (!IsCompressedBuffer(compressedData, compressedSize))
+	{
+		return false;
+	}
+
+	BufferParser compressedParser(compressedData, compressedSize);
+	compressedParser.SetEndianMode(BufferEndian::LITTLE);
+	// The fourCC and version were checked by IsCompressedBuffer
+	compressedParser.SetSeekPosition(4 + 1);
+	uint32_t blockSize = compressedParser.ParseUint32();
+	if (blockSize == 0 || blockSize > COMPRESSION_MAX_BLOCK_SIZE)
+	{
+		return false;
+	}
+
+	struct CompressedBlock
+	{
+		size_t m_storedPosition = 0;
+		size_t m_storedSize = 0;
+		size_t m_uncompressedPosition = 0;
+		size_t m_uncompressedSize = 0;
+	};
+	std::vector<CompressedBlock> blocks;
+	size_t totalUncompressedSize = 0;
+
+	while (true)
+	{
+		if (compressedParser.GetRemainingSize() < static_cast<int>(COMPRESSED_BLOCK_HEADER_SIZE))
+		{
+			return false;
+		}
+
+		CompressedBlock block;
+		block.m_uncompressedSize = compressedParser.ParseUint32();
+		block.m_storedSize = compressedParser.ParseUint32();
+		if (block.m_uncompressedSize == 0)
+		{
+			break;
+		}
+		if (block.m_uncompressedSize > blockSize || block.m_storedSize > block.m_uncompressedSize || block.m_storedSize > static_cast<size_t>(compressedParser.GetRemainingSize()))
+		{
+			return false;
+		}
+		// Checked before anything is allocated, so that a few corrupt headers cannot make out_buffer request more memory than the stored bytes could ever fill
+		if (block.m_storedSize == 0 || block.m_uncompressedSize > block.m_storedSize * COMPRESSION_MAX_EXPANSION_RATIO + COMPRESSION_MAX_EXPANSION_SLACK)
+		{
+			return false;
+		}
+
+		block.m_storedPosition = compressedParser.GetSeekPosition();
+		block.m_uncompressedPosition = totalUncompressedSize;
+		blocks.push_back(block);
+
+		totalUncompressedSize += block.m_uncompressedSize;
+		compressedParser.SetSeekPosition(static_cast<int>(block.m_storedPosition + block.m_storedSize));
+	}
+
+	size_t initialBufferSize = out_buffer.size();
+	out_buffer.resize(initialBufferSize + totalUncompressedSize);
+	uint8_t* uncompressedData = out_buffer.data() + initialBufferSize;
+	std::atomic<bool> areAllBlocksValid = true;
+
+	auto decompressBlock = [&](int blockIndex)
+	{
+		CompressedBlock const& block = blocks[blockIndex];
+		uint8_t const* storedBytes = compressedData + block.m_storedPosition;
+		uint8_t* blockBytes = uncompressedData + block.m_uncompressedPosition;
+
+		if (block.m_storedSize == block.m_uncompressedSize)
+		{
+			memcpy(blockBytes, storedBytes, block.m_storedSize);
+		}
+		else if (!DecompressBlock(storedBytes, block.m_storedSize, blockBytes, block.m_uncompressedSize))
+		{
+			areAllBlocksValid = false;
+		}
+	};
+
+	if (jobSystem && blocks.size() > 1)
+	{
+		ParallelFor(*jobSystem, 0, static_cast<int>(blocks.size()), 1, decompressBlock);
+	}
+	else
+	{
+		for (int blockIndex = 0; blockIndex < static_cast<int>(blocks.size()); blockIndex++)
+		{
+			decompressBlock(blockIndex);
+		}
+	}
+
+	if (!areAllBlocksValid)
+	{
+		out_buffer.resize(initialBufferSize);
+		return false;
+	}
+	return true;
+}
+
+bool DecompressBuffer(std::vector<uint8_t>& out_buffer, std::vector<uint8_t> const& compressedBuffer, JobSystem* jobSystem)
+{
+	return DecompressBuffer(out_buffer, compressedBuffer.data(), compressedBuffer.size(), jobSystem);
+}
+
+
+/*! \brief Starts compressed data at the end of a buffer and creates the BufferWriter that values are appended through
+*
+* \param compressedBuffer The buffer the header and compressed blocks are appended to
+* \param jobSystem The JobSystem whose workers should compress the blocks, or nullptr to compress them on the calling thread
+* \param blockSize The number of uncompressed bytes in each block, at most COMPRESSION_MAX_BLOCK_SIZE. Larger blocks compress slightly better, smaller blocks can be compressed and decompressed by more threads at once
+*
+*/
+CompressedBufferWriter::CompressedBufferWriter(std::vector<uint8_t>& compressedBuffer, JobSystem* jobSystem, int blockSize)
+	: m_compressedBuffer(compressedBuffer)
+	, m_jobSystem(jobSystem)
+	, m_blockSize(blockSize)
+	, m_bufferWriter(m_stagedBytes)
+{
+	GUARANTEE_OR_DIE(blockSize > 0 && blockSize <= COMPRESSION_MAX_BLOCK_SIZE, "Compressed buffers must have a positive block size of at most COMPRESSION_MAX_BLOCK_SIZE");
+
+	BufferWriter headerWriter(m_compressedBuffer);
+	headerWriter.SetEndianMode(BufferEndian::LITTLE);
+	for (int fourCCIndex = 0; fourCCIndex < 4; fourCCIndex++)
+	{
+		headerWriter.AppendByte(COMPRESSED_BUFFER_FOURCC[fourCCIndex]);
+	}
+	headerWriter.AppendByte(COMPRESSED_BUFFER_VERSION);
+	headerWriter.AppendUint32(static_cast<uint32_t>(m_blockSize));
+}
+
+CompressedBufferWriter::~CompressedBufferWriter()
+{
+	Finish();
+}
+
+//! Compresses every full block staged so far and appends it to the compressed buffer, the bytes of the last partial block stay staged
+void CompressedBufferWriter::FlushFullBlocks()
+{
+	GUARANTEE_OR_DIE(!m_isFinished, "Cannot flush a compressed buffer that has been finished");
+
+	int numFullBlocks = static_cast<int>(m_stagedBytes.size() / m_blockSize);
+	CompressBlocks(numFullBlocks, static_cast<size_t>(numFullBlocks) * m_blockSize);
+}
+
+//! Compresses every staged byte and ends the compressed data, nothing can be appended afterwards. Called by the destructor if it has not been called already
+void CompressedBufferWriter::Finish()
+{
+	if (m_isFinished)
+	{
+		return;
+	}
+
+	int numBlocks = static_cast<int>((m_stagedBytes.size() + m_blockSize - 1) / m_blockSize);
+	CompressBlocks(numBlocks, m_stagedBytes.size());
+
+	BufferWriter endWriter(m_compressedBuffer);
+	endWriter.SetEndianMode(BufferEndian::LITTLE);
+	endWriter.AppendUint32(0);
+	endWriter.AppendUint32(0);
+	m_isFinished = true;
+}
+
+// Compresses the first numBytes staged bytes as numBlocks blocks, appends them to the compressed buffer in order and removes them from the staging buffer
+void CompressedBufferWriter::CompressBlocks(int numBlocks, size_t numBytes)
+{
+	if (numBlocks <= 0)
+	{
+		return;
+	}
+
+	std::vector<std::vector<uint8_t>> storedBlocks(numBlocks);
+
+	auto compressBlock = [&](int blockIndex)
+	{
+		size_t blockPosition = static_cast<size_t>(blockIndex) * m_blockSize;
+		size_t blockSize = std::min(static_cast<size_t>(m_blockSize), numBytes - blockPosition);
+		uint8_t const* blockBytes = m_stagedBytes.data() + blockPosition;
+
+		std::vector<uint8_t>& storedBlock = storedBlocks[blockIndex];
+		storedBlock.resize(GetMaxCompressedBlockSize(blockSize));
+		size_t compressedSize = CompressBlock(blockBytes, blockSize, storedBlock.data(), storedBlock.size());
+
+		// Blocks that do not get smaller are stored as they are, so decompressing them is a copy
+		if (compressedSize >= blockSize)
+		{
+			storedBlock.assign(blockBytes, blockBytes + blockSize);
+		}
+		else
+		{
+			storedBlock.resize(compressedSize);
+		}
+	};
+
+	if (m_jobSystem && numBlocks > 1)
+	{
+		ParallelFor(*m_jobSystem, 0, numBlocks, 1, compressBlock);
+	}
+	else
+	{
+		for (int blockIndex = 0; blockIndex < numBlocks; blockIndex++)
+		{
+			compressBlock(blockIndex);
+		}
+	}
+
+	BufferWriter blockWriter(m_compressedBuffer);
+	blockWriter.SetEndianMode(BufferEndian::LITTLE);
+	for (int blockIndex = 0; blockIndex < numBlocks; blockIndex++)
+	{
+		size_t blockPosition = static_cast<size_t>(blockIndex) * m_blockSize;
+		size_t blockSize = std::min(static_cast<size_t>(m_blockSize), numBytes - blockPosition);
+
+		blockWriter.AppendUint32(static_cast<uint32_t>(blockSize));
+		blockWriter.AppendUint32(static_cast<uint32_t>(storedBlocks[blockIndex].size()));
+		m_compressedBuffer.insert(m_compressedBuffer.end(), storedBlocks[blockIndex].begin(), storedBlocks[blockIndex].end());
+	}
+
+	m_stagedBytes.erase(m_stagedBytes.begin(), m_stagedBytes.begin() + numBytes);
+	m_numFlushedBytes += numBytes;
+}
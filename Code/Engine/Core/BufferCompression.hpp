@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Engine/Core/BufferWriter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \file BufferCompression.hpp
+
+class JobSystem;
+
+//! Number of uncompressed bytes in each block of a compressed buffer unless another size is requested
+constexpr int COMPRESSION_DEFAULT_BLOCK_SIZE = 64 * 1024;
+//! Largest block size a compressed buffer can use, DecompressBuffer rejects headers with larger blocks
+constexpr int COMPRESSION_MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+size_t GetMaxCompressedBlockSize(size_t numBytes);
+size_t CompressBlock(uint8_t const* sourceBytes, size_t numSourceBytes, uint8_t* out_compressedBytes, size_t compressedBytesCapacity);
+bool DecompressBlock(uint8_t const* compressedBytes, size_t numCompressedBytes, uint8_t* out_bytes, size_t numBytes);
+
+bool IsCompressedBuffer(uint8_t const* bufferData, size_t bufferSize);
+bool DecompressBuffer(std::vector<uint8_t>& out_buffer, uint8_t const* compressedData, size_t compressedSize, JobSystem* jobSystem = nullptr);
+bool DecompressBuffer(std::vector<uint8_t>& out_buffer, std::vector<uint8_t> const& compressedBuffer, JobSystem* jobSystem = nullptr);
+
+/*! \brief A BufferWriter whose output is compressed in independent blocks with a fast LZ4-style codec
+*
+* Values are appended through GetBufferWriter, which writes to an uncompressed staging buffer. FlushFullBlocks compresses every full block staged so far and appends it to the compressed buffer, so the staging buffer stays small when writing large files, and Finish compresses the last partial block and ends the compressed data. Blocks are compressed in parallel when a JobSystem is given.
+* Flushing removes bytes from the staging buffer, so positions passed to BufferWriter::OverwriteUint32AtPosition are relative to the first byte that has not been flushed yet.
+* The compressed buffer can be written out with FileWriteBuffer and read back with DecompressBuffer.
+*
+*/
+class CompressedBufferWriter
+{
+public:
+	CompressedBufferWriter(std::vector<uint8_t>& compressedBuffer, JobSystem* jobSystem = nullptr, int blockSize = COMPRESSION_DEFAULT_BLOCK_SIZE);
+	~CompressedBufferWriter();
+	CompressedBufferWriter(CompressedBufferWriter const& copyFrom) = delete;
+	CompressedBufferWriter& operator=(CompressedBufferWriter const& assignFrom) = delete;
+
+	BufferWriter& GetBufferWriter() { return m_bufferWriter; }
+
+	void FlushFullBlocks();
+	void Finish();
+
+	bool IsFinished() const { return m_isFinished; }
+	size_t GetTotalUncompressedSize() const { return m_numFlushedBytes + m_stagedBytes.size(); }
+
+private:
+	void CompressBlocks(int numBlocks, size_t numBytes);
+
+private:
+	std::vector<uint8_t>& m_compressedBuffer;
+	JobSystem* m_jobSystem = nullptr;
+	int m_blockSize = COMPRESSION_DEFAULT_BLOCK_SIZE;
+	std::vector<uint8_t> m_stagedBytes;
+	BufferWriter m_bufferWriter;
+	size_t m_numFlushedBytes = 0;
+	bool m_isFinished = false;
+};
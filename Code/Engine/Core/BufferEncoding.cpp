@@ -0,0 +1,50 @@
+#include "Engine/Core/BufferEncoding.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+/*! \brief Maps a float in a range to one of the 2^numBits evenly spaced integers in [0, 2^numBits - 1]
+* 
+* Values outside the range are clamped to it. The ends of the range are represented exactly, and any other value is off by at most half a step, (maxValue - minValue) / (2^numBits - 1) / 2.
+* \param value The float to quantize
+* \param minValue The float represented by 0
+* \param maxValue The float represented by 2^numBits - 1
+* \param numBits The number of bits in the quantized value, from 1 to 32
+* \return The quantized value
+* 
+*/
+uint32_t QuantizeFloat(float value, float minValue, float maxValue, int numBits)
+{
+	GUARANTEE_OR_DIE(numBits >= 1 && numBits <= 32, "Quantized floats must have between 1 and 32 bits");
+	GUARANTEE_OR_DIE(maxValue > minValue, "Cannot quantize a float in an empty range");
+
+	if (!(value > minValue))
+	{
+		return 0;
+	}
+	if (value >= maxValue)
+	{
+		return static_cast<uint32_t>((1ull << numBits) - 1);
+	}
+
+	// Doubles have enough precision for every step of a 32-bit quantized value
+	double maxQuantizedValue = static_cast<double>((1ull << numBits) - 1);
+	double fractionOfRange = (static_cast<double>(value) - static_cast<double>(minValue)) / (static_cast<double>(maxValue) - static_cast<double>(minValue));
+	return static_cast<uint32_t>(fractionOfRange * maxQuantizedValue + 0.5);
+}
+
+//! Maps a value returned by QuantizeFloat with the same range and number of bits back to a float
+float DequantizeFloat(uint32_t quantizedValue, float minValue, float maxValue, int numBits)
+{
+	GUARANTEE_OR_DIE(numBits >= 1 && numBits <= 32, "Quantized floats must have between 1 and 32 bits");
+
+	double maxQuantizedValue = static_cast<double>((1ull << numBits) - 1);
+	double fractionOfRange = static_cast<double>(quantizedValue) / maxQuantizedValue;
+	return static_cast<float>(static_cast<double>(minValue) + fractionOfRange * (static_cast<double>(maxValue) - static_cast<double>(minValue)));
+}
+
+//! Returns the number of whole bytes needed to hold numBits bits
+int GetNumBytesForBits(int numBits)
+{
+	return (numBits + 7) / 8;
+}
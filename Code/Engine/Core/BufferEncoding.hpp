@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+//! \file BufferEncoding.hpp
+
+//! A variable-length uint32_t holds 7 bits per byte, so it takes at most 5 bytes
+constexpr int MAX_VARUINT32_BYTES = 5;
+//! A variable-length uint64_t holds 7 bits per byte, so it takes at most 10 bytes
+constexpr int MAX_VARUINT64_BYTES = 10;
+
+/*! \brief Maps a signed integer to an unsigned one so that values close to zero have few significant bits
+* 
+* 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4..., so small negative values are as cheap to write as variable-length integers as small positive ones.
+* 
+*/
+constexpr uint32_t ZigZagEncodeInt32(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ (0u - (static_cast<uint32_t>(value) >> 31));
+}
+
+constexpr int32_t ZigZagDecodeInt32(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1u)));
+}
+
+constexpr uint64_t ZigZagEncodeInt64(int64_t value)
+{
+	return (static_cast<uint64_t>(value) << 1) ^ (0ull - (static_cast<uint64_t>(value) >> 63));
+}
+
+constexpr int64_t ZigZagDecodeInt64(uint64_t value)
+{
+	return static_cast<int64_t>((value >> 1) ^ (0ull - (value & 1ull)));
+}
+
+uint32_t QuantizeFloat(float value, float minValue, float maxValue, int numBits);
+float DequantizeFloat(uint32_t quantizedValue, float minValue, float maxValue, int numBits);
+int GetNumBytesForBits(int numBits);
@@ -1,10 +1,34 @@
 #include "Engine/Core/BufferParser.hpp"
 
+#include "Engine/Core/BufferEncoding.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
+#include <cstring>
 
-BufferParser::BufferParser(std::vector<uint8_t>& buffer)
-	: m_buffer(buffer)
+
+/*! \brief Creates a parser over the contents of a vector
+* 
+* The parser does not copy the vector, which must not be resized or destroyed while the parser is used.
+* \param buffer The bytes to parse
+* 
+*/
+BufferParser::BufferParser(std::vector<uint8_t> const& buffer)
+	: m_bufferData(buffer.data())
+	, m_bufferSize(buffer.size())
+	, m_position(0)
+{
+}
+
+/*! \brief Creates a parser over memory the parser does not own, such as a MemoryMappedFile
+* 
+* The memory is never modified, including when parsing in the opposite endian mode, and must stay valid for as long as the parser is used.
+* \param bufferData The first byte of the memory to parse
+* \param bufferSize The number of bytes that can be parsed
+* 
+*/
+BufferParser::BufferParser(uint8_t const* bufferData, size_t bufferSize)
+	: m_bufferData(bufferData)
+	, m_bufferSize(bufferSize)
 	, m_position(0)
 {
 }
@@ -24,157 +48,157 @@ void BufferParser::SetEndianMode(BufferEndian endianMode)
 
 unsigned char BufferParser::ParseChar()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + 1, "Buffer position out of bounds for parsing char");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + 1, "Buffer position out of bounds for parsing char");
 
-	return m_buffer[m_position++];
+	return m_bufferData[m_position++];
 }
 
 unsigned char BufferParser::ParseByte()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + 1, "Buffer position out of bounds for parsing byte");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + 1, "Buffer position out of bounds for parsing byte");
 
-	return m_buffer[m_position++];
+	return m_bufferData[m_position++];
 }
 
 bool BufferParser::ParseBool()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + 1, "Buffer position out of bounds for parsing bool");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + 1, "Buffer position out of bounds for parsing bool");
 
-	return m_buffer[m_position++];
+	return m_bufferData[m_position++];
 }
 
 short BufferParser::ParseShort()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(short), "Buffer position out of bounds for parsing short");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(short), "Buffer position out of bounds for parsing short");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	short value;
+	memcpy(&value, m_bufferData + m_position, sizeof(short));
 	m_position += sizeof(short);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseShortBytesInPlace(bytes);
+		ReverseShortBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	short value = *reinterpret_cast<short*>(bytes);
 	return value;
 }
 
 unsigned short BufferParser::ParseUShort()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(unsigned short), "Buffer position out of bounds for parsing ushort");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(unsigned short), "Buffer position out of bounds for parsing ushort");
 
-	uint8_t* bytes = &m_buffer[m_position];
-	m_position += sizeof(short);
+	unsigned short value;
+	memcpy(&value, m_bufferData + m_position, sizeof(unsigned short));
+	m_position += sizeof(unsigned short);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseShortBytesInPlace(bytes);
+		ReverseShortBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	unsigned short value = *reinterpret_cast<short*>(bytes);
 	return value;
 }
 
 uint32_t BufferParser::ParseUint32()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(uint32_t), "Buffer position out of bounds for parsing uint32");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(uint32_t), "Buffer position out of bounds for parsing uint32");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	uint32_t value;
+	memcpy(&value, m_bufferData + m_position, sizeof(uint32_t));
 	m_position += sizeof(uint32_t);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseWordBytesInPlace(bytes);
+		ReverseWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	uint32_t value = *reinterpret_cast<uint32_t*>(bytes);
 	return value;
 }
 
 int32_t BufferParser::ParseInt32()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(int32_t), "Buffer position out of bounds for parsing int32");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(int32_t), "Buffer position out of bounds for parsing int32");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	int32_t value;
+	memcpy(&value, m_bufferData + m_position, sizeof(int32_t));
 	m_position += sizeof(int32_t);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseWordBytesInPlace(bytes);
+		ReverseWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	int32_t value = *reinterpret_cast<int32_t*>(bytes);
 	return value;
 }
 
 uint64_t BufferParser::ParseUint64()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(uint64_t), "Buffer position out of bounds for parsing uint64");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(uint64_t), "Buffer position out of bounds for parsing uint64");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	uint64_t value;
+	memcpy(&value, m_bufferData + m_position, sizeof(uint64_t));
 	m_position += sizeof(uint64_t);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseWordBytesInPlace(bytes);
+		ReverseDWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	uint64_t value = *reinterpret_cast<short*>(bytes);
 	return value;
 }
 
 int64_t BufferParser::ParseInt64()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(int64_t), "Buffer position out of bounds for parsing int64");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(int64_t), "Buffer position out of bounds for parsing int64");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	int64_t value;
+	memcpy(&value, m_bufferData + m_position, sizeof(int64_t));
 	m_position += sizeof(int64_t);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseWordBytesInPlace(bytes);
+		ReverseDWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	int64_t value = *reinterpret_cast<short*>(bytes);
 	return value;
 }
 
 float BufferParser::ParseFloat()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(float), "Buffer position out of bounds for parsing float");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(float), "Buffer position out of bounds for parsing float");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	float value;
+	memcpy(&value, m_bufferData + m_position, sizeof(float));
 	m_position += sizeof(float);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseWordBytesInPlace(bytes);
+		ReverseWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	float value = *reinterpret_cast<float*>(bytes);
 	return value;
 }
 
 double BufferParser::ParseDouble()
 {
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + sizeof(double), "Buffer position out of bounds for parsing double");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + sizeof(double), "Buffer position out of bounds for parsing double");
 
-	uint8_t* bytes = &m_buffer[m_position];
+	double value;
+	memcpy(&value, m_bufferData + m_position, sizeof(double));
 	m_position += sizeof(double);
 
 	if (m_isReadingInOppositeEndianMode)
 	{
-		ReverseDWordBytesInPlace(bytes);
+		ReverseDWordBytesInPlace(reinterpret_cast<uint8_t*>(&value));
 	}
 
-	double value = *reinterpret_cast<double*>(bytes);
 	return value;
 }
 
 void BufferParser::ParseStringZeroTerminated(std::string& out_string)
 {
 	char strChar = ParseChar();
-	while (strChar != 0 && m_position < m_buffer.size())
+	while (strChar != 0 && m_position < m_bufferSize)
 	{
 		out_string += strChar;
 		strChar = ParseChar();
@@ -185,12 +209,32 @@ void BufferParser::ParseStringAfter32BitLength(std::string& out_string)
 {
 	uint32_t strLength = ParseUint32();
 
-	GUARANTEE_OR_DIE(m_buffer.size() >= m_position + strLength, "Buffer position out of bounds for parsing string");
+	// Compared without adding to the position, so that a corrupt length close to UINT32_MAX cannot wrap around and pass
+	GUARANTEE_OR_DIE(strLength <= m_bufferSize - static_cast<size_t>(m_position), "Buffer position out of bounds for parsing string");
+
+	out_string.append(reinterpret_cast<char const*>(m_bufferData + m_position), strLength);
+	m_position += strLength;
+}
 
-	for (int charIndex = 0; charIndex < (int)strLength; charIndex++)
+//! Parses a string like ParseStringAfter32BitLength from a buffer that may be corrupt, returning false and leaving the position unchanged instead of failing a GUARANTEE_OR_DIE if the length or string does not fit in the rest of the buffer
+bool BufferParser::TryParseStringAfter32BitLength(std::string& out_string)
+{
+	if (GetRemainingSize() < static_cast<int>(sizeof(uint32_t)))
 	{
-		out_string += ParseChar();
+		return false;
 	}
+
+	int lengthPosition = m_position;
+	uint32_t strLength = ParseUint32();
+	if (strLength > m_bufferSize - static_cast<size_t>(m_position))
+	{
+		m_position = lengthPosition;
+		return false;
+	}
+
+	out_string.append(reinterpret_cast<char const*>(m_bufferData + m_position), strLength);
+	m_position += strLength;
+	return true;
 }
 
 Rgba8 const BufferParser::ParseRgba()
@@ -256,7 +300,99 @@ Vertex_PCU const BufferParser::ParseVertexPCU()
 	return result;
 }
 
+//! Parses a uint32_t written with BufferWriter::AppendVarUint32
+uint32_t BufferParser::ParseVarUint32()
+{
+	uint32_t result = 0;
+	for (int byteIndex = 0; byteIndex < MAX_VARUINT32_BYTES; byteIndex++)
+	{
+		GUARANTEE_OR_DIE(m_bufferSize >= m_position + 1, "Buffer position out of bounds for parsing variable-length uint32");
+
+		uint8_t byte = m_bufferData[m_position++];
+		result |= static_cast<uint32_t>(byte & 0x7F) << (7 * byteIndex);
+		if (!(byte & 0x80))
+		{
+			return result;
+		}
+	}
+
+	ERROR_AND_DIE("Variable-length uint32 is longer than 5 bytes");
+}
+
+//! Parses a uint64_t written with BufferWriter::AppendVarUint64
+uint64_t BufferParser::ParseVarUint64()
+{
+	uint64_t result = 0;
+	for (int byteIndex = 0; byteIndex < MAX_VARUINT64_BYTES; byteIndex++)
+	{
+		GUARANTEE_OR_DIE(m_bufferSize >= m_position + 1, "Buffer position out of bounds for parsing variable-length uint64");
+
+		uint8_t byte = m_bufferData[m_position++];
+		result |= static_cast<uint64_t>(byte & 0x7F) << (7 * byteIndex);
+		if (!(byte & 0x80))
+		{
+			return result;
+		}
+	}
+
+	ERROR_AND_DIE("Variable-length uint64 is longer than 10 bytes");
+}
+
+int32_t BufferParser::ParseVarInt32()
+{
+	return ZigZagDecodeInt32(ParseVarUint32());
+}
+
+int64_t BufferParser::ParseVarInt64()
+{
+	return ZigZagDecodeInt64(ParseVarUint64());
+}
+
+//! Parses an int32_t written with BufferWriter::AppendDeltaInt32, previousInt32 must be the value it was written against
+int32_t BufferParser::ParseDeltaInt32(int32_t previousInt32)
+{
+	uint32_t delta = static_cast<uint32_t>(ParseVarInt32());
+	return static_cast<int32_t>(static_cast<uint32_t>(previousInt32) + delta);
+}
+
+int64_t BufferParser::ParseDeltaInt64(int64_t previousInt64)
+{
+	uint64_t delta = static_cast<uint64_t>(ParseVarInt64());
+	return static_cast<int64_t>(static_cast<uint64_t>(previousInt64) + delta);
+}
+
+//! Parses a float written with BufferWriter::AppendQuantizedFloat with the same range and number of bits
+float BufferParser::ParseQuantizedFloat(float minValue, float maxValue, int numBits)
+{
+	return DequantizeFloat(ParseUintOfSize(GetNumBytesForBits(numBits)), minValue, maxValue, numBits);
+}
+
+Vec3 const BufferParser::ParseQuantizedVec3(Vec3 const& minValues, Vec3 const& maxValues, int numBits)
+{
+	Vec3 result;
+	result.x = ParseQuantizedFloat(minValues.x, maxValues.x, numBits);
+	result.y = ParseQuantizedFloat(minValues.y, maxValues.y, numBits);
+	result.z = ParseQuantizedFloat(minValues.z, maxValues.z, numBits);
+	return result;
+}
+
 void BufferParser::SetSeekPosition(int seekPosition)
 {
 	m_position = seekPosition;
 }
+
+// Parses an unsigned integer of numBytes bytes written in the endian mode of the buffer
+uint32_t BufferParser::ParseUintOfSize(int numBytes)
+{
+	GUARANTEE_OR_DIE(numBytes >= 1 && numBytes <= 4, "Can only parse unsigned integers of 1 to 4 bytes");
+	GUARANTEE_OR_DIE(m_bufferSize >= m_position + static_cast<size_t>(numBytes), "Buffer position out of bounds for parsing quantized value");
+
+	bool isReadingBigEndian = (m_endianMode == BufferEndian::BIG) || (m_endianMode == BufferEndian::NATIVE && GetPlatformNativeEndianMode() == BufferEndian::BIG);
+	uint32_t result = 0;
+	for (int byteIndex = 0; byteIndex < numBytes; byteIndex++)
+	{
+		int shiftBytes = isReadingBigEndian ? (numBytes - 1 - byteIndex) : byteIndex;
+		result |= static_cast<uint32_t>(m_bufferData[m_position++]) << (8 * shiftBytes);
+	}
+	return result;
+}
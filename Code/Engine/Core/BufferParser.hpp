@@ -1,20 +1,25 @@
 #pragma once
 
+#include "Engine/Core/BufferSpan.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 
 class BufferParser
 {
 public:
-	BufferParser(std::vector<uint8_t>& buffer);
+	BufferParser(std::vector<uint8_t> const& buffer);
+	BufferParser(uint8_t const* bufferData, size_t bufferSize);
 
 	void SetEndianMode(BufferEndian endianMode);
 	BufferEndian GetEndianMode() const { return m_endianMode; }
@@ -32,6 +37,7 @@ public:
 	double ParseDouble();
 	void ParseStringZeroTerminated(std::string& out_string);
 	void ParseStringAfter32BitLength(std::string& out_string);
+	bool TryParseStringAfter32BitLength(std::string& out_string);
 
 	Rgba8 const ParseRgba();
 	Rgba8 const ParseRgb();
@@ -41,15 +47,64 @@ public:
 	EulerAngles const ParseEulerAngles();
 	Vertex_PCU const ParseVertexPCU();
 
+	uint32_t ParseVarUint32();
+	uint64_t ParseVarUint64();
+	int32_t ParseVarInt32();
+	int64_t ParseVarInt64();
+	int32_t ParseDeltaInt32(int32_t previousInt32);
+	int64_t ParseDeltaInt64(int64_t previousInt64);
+	float ParseQuantizedFloat(float minValue, float maxValue, int numBits);
+	Vec3 const ParseQuantizedVec3(Vec3 const& minValues, Vec3 const& maxValues, int numBits);
+
+	/*! \brief Parses an array of elements written with BufferWriter::AppendSpan with a single copy
+	* 
+	* The bytes are copied straight into the elements, and reversed in blocks afterwards only if the buffer uses the opposite endianness.
+	* \param out_elements The array the elements are parsed into, must have room for numElements elements
+	* \param numElements The number of elements to parse
+	* 
+	*/
+	template<typename T>
+	void ParseSpan(T* out_elements, int numElements)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "ParseSpan can only parse trivially copyable types");
+		if (numElements <= 0)
+		{
+			return;
+		}
+
+		size_t numSpanBytes = sizeof(T) * static_cast<size_t>(numElements);
+		GUARANTEE_OR_DIE(m_bufferSize >= m_position + numSpanBytes, "Buffer position out of bounds for parsing span");
+
+		memcpy(out_elements, m_bufferData + m_position, numSpanBytes);
+		m_position += static_cast<int>(numSpanBytes);
+
+		if (m_isReadingInOppositeEndianMode)
+		{
+			ReverseSpanBytesInPlace<T>(reinterpret_cast<uint8_t*>(out_elements), numElements);
+		}
+	}
+
+	template<typename T>
+	void ParseSpan(std::vector<T>& out_elements, int numElements)
+	{
+		out_elements.resize(numElements);
+		ParseSpan(out_elements.data(), numElements);
+	}
+
 	uint32_t GetSeekPosition() const { return m_position; } 
 	void SetSeekPosition(int seekPosition);
 
-	int GetRemainingSize() const { return (int)m_buffer.size() - m_position; }
-	int GetTotalSize() const { return (int)m_buffer.size(); }
+	int GetRemainingSize() const { return (int)m_bufferSize - m_position; }
+	int GetTotalSize() const { return (int)m_bufferSize; }
 
 public:
-	std::vector<uint8_t>& m_buffer;
+	//! The parsed memory is never written to, so it can be read-only memory such as a MemoryMappedFile
+	uint8_t const* m_bufferData = nullptr;
+	size_t m_bufferSize = 0;
 	int m_position = 0;
 	BufferEndian m_endianMode = BufferEndian::NATIVE;
 	bool m_isReadingInOppositeEndianMode = false;
+
+private:
+	uint32_t ParseUintOfSize(int numBytes);
 };
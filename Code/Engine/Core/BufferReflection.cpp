@@ -0,0 +1,115 @@
+#include "Engine/Core/BufferReflection.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------------------------
+// Combines the layouts of the fields of a struct, given in schema order, into the layout of the struct. Byte fields such as Rgba8 inside a struct of larger words are marked as unswapped words
+BufferPackedLayout MakeBufferPackedLayout(std::vector<BufferPackedField> const& fields, size_t structSize)
+{
+	BufferPackedLayout layout;
+	size_t numPackedBytes = 0;
+	bool canReverseWords = true;
+	size_t wordSize = 1;
+
+	for (int fieldIndex = 0; fieldIndex < static_cast<int>(fields.size()); fieldIndex++)
+	{
+		BufferPackedField const& field = fields[fieldIndex];
+		if (!field.m_layout.m_isPacked || field.m_offset != numPackedBytes)
+		{
+			return layout;
+		}
+
+		numPackedBytes += field.m_size;
+		canReverseWords = canReverseWords && field.m_layout.m_canReverseWords;
+		if (field.m_layout.m_wordSize > wordSize)
+		{
+			wordSize = field.m_layout.m_wordSize;
+		}
+	}
+
+	// Fields that do not cover the whole struct leave padding, or members that are not serialized
+	if (numPackedBytes != structSize || structSize == 0)
+	{
+		return layout;
+	}
+
+	layout.m_isPacked = true;
+	if (!canReverseWords || structSize % wordSize != 0 || structSize / wordSize > 64)
+	{
+		return layout;
+	}
+
+	uint64_t unswappedWordMask = 0;
+	for (int fieldIndex = 0; fieldIndex < static_cast<int>(fields.size()); fieldIndex++)
+	{
+		BufferPackedField const& field = fields[fieldIndex];
+		if (field.m_offset % wordSize != 0 || field.m_size % wordSize != 0)
+		{
+			return layout;
+		}
+
+		size_t firstWordIndex = field.m_offset / wordSize;
+		size_t numFieldWords = field.m_size / wordSize;
+		if (field.m_layout.m_wordSize == wordSize)
+		{
+			unswappedWordMask |= field.m_layout.m_unswappedWordMask << firstWordIndex;
+		}
+		else if (field.m_layout.m_wordSize == 1)
+		{
+			uint64_t fieldWordsMask = (numFieldWords >= 64) ? ~0ull : ((1ull << numFieldWords) - 1);
+			unswappedWordMask |= fieldWordsMask << firstWordIndex;
+		}
+		else
+		{
+			return layout;
+		}
+	}
+
+	layout.m_canReverseWords = true;
+	layout.m_wordSize = wordSize;
+	layout.m_unswappedWordMask = unswappedWordMask;
+	return layout;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Appends the raw bytes of an array of packed elements, reversing their words afterwards if the buffer uses the opposite endianness
+void AppendPackedElements(BufferWriter& bufferWriter, void const* elements, size_t elementSize, int numElements, BufferPackedLayout const& layout)
+{
+	if (numElements <= 0)
+	{
+		return;
+	}
+
+	size_t packedPosition = bufferWriter.m_buffer.size();
+	uint8_t const* elementBytes = reinterpret_cast<uint8_t const*>(elements);
+	bufferWriter.m_buffer.insert(bufferWriter.m_buffer.end(), elementBytes, elementBytes + elementSize * static_cast<size_t>(numElements));
+
+	if (bufferWriter.m_isWritingInOppositeEndianMode)
+	{
+		ReverseSpanBytesInPlace(bufferWriter.m_buffer.data() + packedPosition, elementSize, numElements, layout.m_wordSize, layout.m_unswappedWordMask);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// Parses an array of packed elements appended with AppendPackedElements
+void ParsePackedElements(BufferParser& bufferParser, void* out_elements, size_t elementSize, int numElements, BufferPackedLayout const& layout)
+{
+	if (numElements <= 0)
+	{
+		return;
+	}
+
+	size_t numPackedBytes = elementSize * static_cast<size_t>(numElements);
+	GUARANTEE_OR_DIE(bufferParser.m_bufferSize >= bufferParser.m_position + numPackedBytes, "Buffer position out of bounds for parsing packed elements");
+
+	memcpy(out_elements, bufferParser.m_bufferData + bufferParser.m_position, numPackedBytes);
+	bufferParser.m_position += static_cast<int>(numPackedBytes);
+
+	if (bufferParser.m_isReadingInOppositeEndianMode)
+	{
+		ReverseSpanBytesInPlace(reinterpret_cast<uint8_t*>(out_elements), elementSize, numElements, layout.m_wordSize, layout.m_unswappedWordMask);
+	}
+}
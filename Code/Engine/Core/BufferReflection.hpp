@@ -0,0 +1,617 @@
+#pragma once
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferSpan.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! \file BufferReflection.hpp
+
+/*! \brief A member of a struct described by a BufferSchema, usually created with BUFFER_SCHEMA_FIELD
+*
+*/
+template<typename Class, typename Member>
+struct BufferSchemaField
+{
+public:
+	using ClassType = Class;
+	using MemberType = Member;
+
+	char const* m_name = nullptr;
+	Member Class::* m_member = nullptr;
+};
+
+//! Describes the member memberName of ClassName in the FIELDS of a BufferSchema
+#define BUFFER_SCHEMA_FIELD(ClassName, memberName) BufferSchemaField<ClassName, decltype(ClassName::memberName)>{ #memberName, &ClassName::memberName }
+
+/*! \brief Lists the fields of a struct so that AppendReflected and ParseReflected can serialize it without hand-written Append and Parse functions
+*
+* Specialize this template with a VERSION and a tuple of FIELDS in the order they are serialized, for example:
+*
+*	template<>
+*	struct BufferSchema<SavedActor>
+*	{
+*		static constexpr uint32_t VERSION = 1;
+*		static constexpr auto FIELDS = std::make_tuple(
+*			BUFFER_SCHEMA_FIELD(SavedActor, m_position),
+*			BUFFER_SCHEMA_FIELD(SavedActor, m_orientation),
+*			BUFFER_SCHEMA_FIELD(SavedActor, m_color));
+*	};
+*
+* Fields can be arithmetic types, enums, std::string, Vec2, Vec3, IntVec2, Rgba8, EulerAngles, Vertex_PCU, other structs with a BufferSchema, and std::vectors of any of these, including std::vector<bool>. Structs with a BufferSchema must be default constructible.
+* Changing the fields, their names or types, or the VERSION changes the value of GetBufferSchemaHash, so data written with an older layout is rejected by ParseReflectedWithSchemaHash instead of being misread.
+*
+*/
+template<typename T>
+struct BufferSchema
+{
+};
+
+//! \cond
+// Hides the implementation details from doxygen documentation
+template<typename T, typename = void>
+struct HasBufferSchema : std::false_type
+{
+};
+
+template<typename T>
+struct HasBufferSchema<T, std::void_t<decltype(BufferSchema<T>::FIELDS), decltype(BufferSchema<T>::VERSION)>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsStdVector : std::false_type
+{
+};
+
+template<typename Element, typename Allocator>
+struct IsStdVector<std::vector<Element, Allocator>> : std::true_type
+{
+};
+
+template<typename T>
+struct AlwaysFalse : std::false_type
+{
+};
+
+// Engine types whose Append and Parse functions write their fields in memory order, so their serialized bytes are their raw bytes as described by BufferSpanLayout
+template<typename T>
+constexpr bool IsBufferEngineValue()
+{
+	return std::is_same_v<T, Vec2> || std::is_same_v<T, Vec3> || std::is_same_v<T, IntVec2> || std::is_same_v<T, Rgba8> || std::is_same_v<T, EulerAngles> || std::is_same_v<T, Vertex_PCU>;
+}
+
+// Whether a span of T can be appended with BufferWriter::AppendSpan. Bools are excluded because parsing a byte other than 0 or 1 into a bool is undefined
+template<typename T>
+constexpr bool CanUseBufferSpan()
+{
+	return !std::is_same_v<T, bool> && (std::is_arithmetic_v<T> || std::is_enum_v<T> || IsBufferEngineValue<T>());
+}
+
+// FNV-1a, used to build schema hashes at compile time
+constexpr uint32_t BUFFER_SCHEMA_HASH_BASIS = 2166136261u;
+
+constexpr uint32_t HashBufferSchemaText(uint32_t hash, char const* text)
+{
+	for (; *text != '\0'; text++)
+	{
+		hash = (hash ^ static_cast<uint8_t>(*text)) * 16777619u;
+	}
+	return hash;
+}
+
+constexpr uint32_t HashBufferSchemaValue(uint32_t hash, uint32_t value)
+{
+	for (int byteIndex = 0; byteIndex < 4; byteIndex++)
+	{
+		hash = (hash ^ ((value >> (8 * byteIndex)) & 0xFF)) * 16777619u;
+	}
+	return hash;
+}
+
+template<typename T>
+constexpr uint32_t GetBufferSchemaHash();
+
+// Hash of how a value of type T is serialized, which does not depend on any names in the code except the field names of schemas
+template<typename T>
+constexpr uint32_t GetBufferValueTypeHash()
+{
+	if constexpr (HasBufferSchema<T>::value)
+	{
+		return GetBufferSchemaHash<T>();
+	}
+	else if constexpr (std::is_same_v<T, bool>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "bool");
+	}
+	else if constexpr (std::is_enum_v<T>)
+	{
+		return GetBufferValueTypeHash<std::underlying_type_t<T>>();
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		return HashBufferSchemaValue(HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "float"), sizeof(T));
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		return HashBufferSchemaValue(HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, std::is_signed_v<T> ? "int" : "uint"), sizeof(T));
+	}
+	else if constexpr (std::is_same_v<T, std::string>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "string");
+	}
+	else if constexpr (std::is_same_v<T, Vec2>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "Vec2");
+	}
+	else if constexpr (std::is_same_v<T, Vec3>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "Vec3");
+	}
+	else if constexpr (std::is_same_v<T, IntVec2>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "IntVec2");
+	}
+	else if constexpr (std::is_same_v<T, Rgba8>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "Rgba8");
+	}
+	else if constexpr (std::is_same_v<T, EulerAngles>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "EulerAngles");
+	}
+	else if constexpr (std::is_same_v<T, Vertex_PCU>)
+	{
+		return HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "Vertex_PCU");
+	}
+	else if constexpr (IsStdVector<T>::value)
+	{
+		return HashBufferSchemaValue(HashBufferSchemaText(BUFFER_SCHEMA_HASH_BASIS, "vector"), GetBufferValueTypeHash<typename T::value_type>());
+	}
+	else
+	{
+		static_assert(AlwaysFalse<T>::value, "Type cannot be serialized with AppendReflected, it needs a BufferSchema");
+		return 0;
+	}
+}
+
+template<typename Class, typename Member>
+constexpr uint32_t HashBufferSchemaField(uint32_t hash, BufferSchemaField<Class, Member> const& field)
+{
+	hash = HashBufferSchemaText(hash, field.m_name);
+	return HashBufferSchemaValue(hash, GetBufferValueTypeHash<Member>());
+}
+
+template<typename T, size_t... FieldIndexes>
+constexpr uint32_t HashBufferSchemaFields(uint32_t hash, std::index_sequence<FieldIndexes...>)
+{
+	((hash = HashBufferSchemaField(hash, std::get<FieldIndexes>(BufferSchema<T>::FIELDS))), ...);
+	return hash;
+}
+//! \endcond
+
+/*! \brief Returns a hash of the VERSION and fields of the BufferSchema of T, computed at compile time
+*
+* The hash covers the name and serialized type of every field in order, including the fields of nested schemas, so any change to what AppendReflected writes for T changes it.
+*
+*/
+template<typename T>
+constexpr uint32_t GetBufferSchemaHash()
+{
+	static_assert(HasBufferSchema<T>::value, "GetBufferSchemaHash needs a BufferSchema specialization with VERSION and FIELDS");
+
+	constexpr size_t numFields = std::tuple_size_v<std::decay_t<decltype(BufferSchema<T>::FIELDS)>>;
+	uint32_t hash = HashBufferSchemaValue(BUFFER_SCHEMA_HASH_BASIS, static_cast<uint32_t>(BufferSchema<T>::VERSION));
+	return HashBufferSchemaFields<T>(hash, std::make_index_sequence<numFields>());
+}
+
+/*! \brief Describes whether the serialized bytes of a struct are the bytes of the struct in memory
+*
+* A struct is packed when its schema fields are packed, are listed in memory order and cover every byte of the struct, so it has no padding. Packed structs and arrays of them are copied with a single block copy.
+* When the buffer uses the opposite endianness the copied bytes must also be reversed, which is only possible when every field is made up of words of the same size or of bytes (such as an Rgba8).
+*
+*/
+struct BufferPackedLayout
+{
+public:
+	bool m_isPacked = false;
+	bool m_canReverseWords = false;
+	size_t m_wordSize = 1;
+	uint64_t m_unswappedWordMask = 0;
+};
+
+//! \cond
+// Hides the implementation details from doxygen documentation
+struct BufferPackedField
+{
+public:
+	BufferPackedLayout m_layout;
+	size_t m_offset = 0;
+	size_t m_size = 0;
+};
+
+BufferPackedLayout MakeBufferPackedLayout(std::vector<BufferPackedField> const& fields, size_t structSize);
+void AppendPackedElements(BufferWriter& bufferWriter, void const* elements, size_t elementSize, int numElements, BufferPackedLayout const& layout);
+void ParsePackedElements(BufferParser& bufferParser, void* out_elements, size_t elementSize, int numElements, BufferPackedLayout const& layout);
+
+template<typename T>
+BufferPackedLayout const& GetBufferPackedLayout();
+
+template<typename T>
+BufferPackedLayout ComputeBufferPackedLayout()
+{
+	BufferPackedLayout layout;
+	if constexpr (CanUseBufferSpan<T>())
+	{
+		layout.m_isPacked = true;
+		layout.m_canReverseWords = true;
+		layout.m_wordSize = BufferSpanLayout<T>::WORD_SIZE;
+		layout.m_unswappedWordMask = BufferSpanLayout<T>::UNSWAPPED_WORD_MASK;
+	}
+	else if constexpr (HasBufferSchema<T>::value && std::is_trivially_copyable_v<T>)
+	{
+		// Member offsets cannot be read from member pointers at compile time, so they are measured on a default constructed object
+		T const layoutObject{};
+		uint8_t const* objectBytes = reinterpret_cast<uint8_t const*>(&layoutObject);
+		std::vector<BufferPackedField> packedFields;
+
+		std::apply([&](auto const&... fields)
+		{
+			(packedFields.push_back({ GetBufferPackedLayout<typename std::decay_t<decltype(fields)>::MemberType>(),
+				static_cast<size_t>(reinterpret_cast<uint8_t const*>(&(layoutObject.*fields.m_member)) - objectBytes),
+				sizeof(typename std::decay_t<decltype(fields)>::MemberType) }), ...);
+		}, BufferSchema<T>::FIELDS);
+
+		layout = MakeBufferPackedLayout(packedFields, sizeof(T));
+	}
+	return layout;
+}
+
+// Computed once per type on first use
+template<typename T>
+BufferPackedLayout const& GetBufferPackedLayout()
+{
+	static BufferPackedLayout const s_layout = ComputeBufferPackedLayout<T>();
+	return s_layout;
+}
+
+template<typename T>
+bool CanCopyPackedElements(BufferPackedLayout const& layout, bool isInOppositeEndianMode)
+{
+	return std::is_trivially_copyable_v<T> && layout.m_isPacked && (!isInOppositeEndianMode || layout.m_canReverseWords);
+}
+//! \endcond
+
+/*! \brief Appends a value using the Append function for its type, or its BufferSchema
+*
+* Structs with a BufferSchema are copied with a single block copy when their layout is packed, otherwise their fields are appended one at a time in the order of the schema. std::vectors are appended as their uint32_t size followed by their elements, which are block copied when possible.
+* \param bufferWriter The writer to append to
+* \param value The value to append
+* \sa BufferSchema, BufferPackedLayout
+*
+*/
+template<typename T>
+void AppendReflected(BufferWriter& bufferWriter, T const& value)
+{
+	if constexpr (HasBufferSchema<T>::value)
+	{
+		BufferPackedLayout const& layout = GetBufferPackedLayout<T>();
+		if (CanCopyPackedElements<T>(layout, bufferWriter.m_isWritingInOppositeEndianMode))
+		{
+			AppendPackedElements(bufferWriter, &value, sizeof(T), 1, layout);
+			return;
+		}
+
+		std::apply([&](auto const&... fields)
+		{
+			(AppendReflected(bufferWriter, value.*fields.m_member), ...);
+		}, BufferSchema<T>::FIELDS);
+	}
+	else if constexpr (std::is_same_v<T, bool>)
+	{
+		bufferWriter.AppendBool(value);
+	}
+	else if constexpr (std::is_enum_v<T>)
+	{
+		AppendReflected(bufferWriter, static_cast<std::underlying_type_t<T>>(value));
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
+	{
+		bufferWriter.AppendByte(static_cast<unsigned char>(value));
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 2)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			bufferWriter.AppendShort(static_cast<short>(value));
+		}
+		else
+		{
+			bufferWriter.AppendUShort(static_cast<unsigned short>(value));
+		}
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 4)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			bufferWriter.AppendInt32(static_cast<int32_t>(value));
+		}
+		else
+		{
+			bufferWriter.AppendUint32(static_cast<uint32_t>(value));
+		}
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 8)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			bufferWriter.AppendInt64(static_cast<int64_t>(value));
+		}
+		else
+		{
+			bufferWriter.AppendUint64(static_cast<uint64_t>(value));
+		}
+	}
+	else if constexpr (std::is_same_v<T, float>)
+	{
+		bufferWriter.AppendFloat(value);
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		bufferWriter.AppendDouble(value);
+	}
+	else if constexpr (std::is_same_v<T, std::string>)
+	{
+		bufferWriter.AppendStringAfter32BitLength(value);
+	}
+	else if constexpr (std::is_same_v<T, Vec2>)
+	{
+		bufferWriter.AppendVec2(value);
+	}
+	else if constexpr (std::is_same_v<T, Vec3>)
+	{
+		bufferWriter.AppendVec3(value);
+	}
+	else if constexpr (std::is_same_v<T, IntVec2>)
+	{
+		bufferWriter.AppendIntVec2(value);
+	}
+	else if constexpr (std::is_same_v<T, Rgba8>)
+	{
+		bufferWriter.AppendRgba(value);
+	}
+	else if constexpr (std::is_same_v<T, EulerAngles>)
+	{
+		bufferWriter.AppendEulerAngles(value);
+	}
+	else if constexpr (std::is_same_v<T, Vertex_PCU>)
+	{
+		bufferWriter.AppendVertexPCU(value);
+	}
+	else if constexpr (IsStdVector<T>::value)
+	{
+		using Element = typename T::value_type;
+		int numElements = static_cast<int>(value.size());
+		bufferWriter.AppendUint32(static_cast<uint32_t>(numElements));
+
+		if constexpr (std::is_same_v<Element, bool>)
+		{
+			// std::vector<bool> packs its elements into bits, so there is no array of bools to copy
+			for (int elementIndex = 0; elementIndex < numElements; elementIndex++)
+			{
+				bufferWriter.AppendBool(value[elementIndex]);
+			}
+		}
+		else if constexpr (CanUseBufferSpan<Element>())
+		{
+			bufferWriter.AppendSpan(value.data(), numElements);
+		}
+		else
+		{
+			BufferPackedLayout const& layout = GetBufferPackedLayout<Element>();
+			if (CanCopyPackedElements<Element>(layout, bufferWriter.m_isWritingInOppositeEndianMode))
+			{
+				AppendPackedElements(bufferWriter, value.data(), sizeof(Element), numElements, layout);
+				return;
+			}
+
+			for (int elementIndex = 0; elementIndex < numElements; elementIndex++)
+			{
+				AppendReflected(bufferWriter, value[elementIndex]);
+			}
+		}
+	}
+	else
+	{
+		static_assert(AlwaysFalse<T>::value, "Type cannot be serialized with AppendReflected, it needs a BufferSchema");
+	}
+}
+
+//! Parses a value appended with AppendReflected \sa AppendReflected
+template<typename T>
+void ParseReflected(BufferParser& bufferParser, T& out_value)
+{
+	if constexpr (HasBufferSchema<T>::value)
+	{
+		BufferPackedLayout const& layout = GetBufferPackedLayout<T>();
+		if (CanCopyPackedElements<T>(layout, bufferParser.m_isReadingInOppositeEndianMode))
+		{
+			ParsePackedElements(bufferParser, &out_value, sizeof(T), 1, layout);
+			return;
+		}
+
+		std::apply([&](auto const&... fields)
+		{
+			(ParseReflected(bufferParser, out_value.*fields.m_member), ...);
+		}, BufferSchema<T>::FIELDS);
+	}
+	else if constexpr (std::is_same_v<T, bool>)
+	{
+		out_value = bufferParser.ParseBool();
+	}
+	else if constexpr (std::is_enum_v<T>)
+	{
+		std::underlying_type_t<T> underlyingValue;
+		ParseReflected(bufferParser, underlyingValue);
+		out_value = static_cast<T>(underlyingValue);
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 1)
+	{
+		out_value = static_cast<T>(bufferParser.ParseByte());
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 2)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			out_value = static_cast<T>(bufferParser.ParseShort());
+		}
+		else
+		{
+			out_value = static_cast<T>(bufferParser.ParseUShort());
+		}
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 4)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			out_value = static_cast<T>(bufferParser.ParseInt32());
+		}
+		else
+		{
+			out_value = static_cast<T>(bufferParser.ParseUint32());
+		}
+	}
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == 8)
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			out_value = static_cast<T>(bufferParser.ParseInt64());
+		}
+		else
+		{
+			out_value = static_cast<T>(bufferParser.ParseUint64());
+		}
+	}
+	else if constexpr (std::is_same_v<T, float>)
+	{
+		out_value = bufferParser.ParseFloat();
+	}
+	else if constexpr (std::is_same_v<T, double>)
+	{
+		out_value = bufferParser.ParseDouble();
+	}
+	else if constexpr (std::is_same_v<T, std::string>)
+	{
+		out_value.clear();
+		bufferParser.ParseStringAfter32BitLength(out_value);
+	}
+	else if constexpr (std::is_same_v<T, Vec2>)
+	{
+		out_value = bufferParser.ParseVec2();
+	}
+	else if constexpr (std::is_same_v<T, Vec3>)
+	{
+		out_value = bufferParser.ParseVec3();
+	}
+	else if constexpr (std::is_same_v<T, IntVec2>)
+	{
+		out_value = bufferParser.ParseIntVec2();
+	}
+	else if constexpr (std::is_same_v<T, Rgba8>)
+	{
+		out_value = bufferParser.ParseRgba();
+	}
+	else if constexpr (std::is_same_v<T, EulerAngles>)
+	{
+		out_value = bufferParser.ParseEulerAngles();
+	}
+	else if constexpr (std::is_same_v<T, Vertex_PCU>)
+	{
+		out_value = bufferParser.ParseVertexPCU();
+	}
+	else if constexpr (IsStdVector<T>::value)
+	{
+		using Element = typename T::value_type;
+		uint32_t numElements = bufferParser.ParseUint32();
+		GUARANTEE_OR_DIE(numElements <= static_cast<uint32_t>(bufferParser.GetRemainingSize()), "Buffer position out of bounds for parsing vector");
+
+		if constexpr (std::is_same_v<Element, bool>)
+		{
+			out_value.clear();
+			out_value.resize(numElements);
+			for (uint32_t elementIndex = 0; elementIndex < numElements; elementIndex++)
+			{
+				out_value[elementIndex] = bufferParser.ParseBool();
+			}
+		}
+		else if constexpr (CanUseBufferSpan<Element>())
+		{
+			bufferParser.ParseSpan(out_value, static_cast<int>(numElements));
+		}
+		else
+		{
+			out_value.clear();
+			out_value.resize(numElements);
+
+			BufferPackedLayout const& layout = GetBufferPackedLayout<Element>();
+			if (CanCopyPackedElements<Element>(layout, bufferParser.m_isReadingInOppositeEndianMode))
+			{
+				ParsePackedElements(bufferParser, out_value.data(), sizeof(Element), static_cast<int>(numElements), layout);
+				return;
+			}
+
+			for (uint32_t elementIndex = 0; elementIndex < numElements; elementIndex++)
+			{
+				ParseReflected(bufferParser, out_value[elementIndex]);
+			}
+		}
+	}
+	else
+	{
+		static_assert(AlwaysFalse<T>::value, "Type cannot be serialized with ParseReflected, it needs a BufferSchema");
+	}
+}
+
+/*! \brief Appends the schema hash of T followed by the value, so that ParseReflectedWithSchemaHash can check the data was written with the same layout
+*
+* \sa GetBufferSchemaHash
+*
+*/
+template<typename T>
+void AppendReflectedWithSchemaHash(BufferWriter& bufferWriter, T const& value)
+{
+	bufferWriter.AppendUint32(GetBufferValueTypeHash<T>());
+	AppendReflected(bufferWriter, value);
+}
+
+/*! \brief Parses a value appended with AppendReflectedWithSchemaHash
+*
+* \param bufferParser The parser to parse from
+* \param out_value The value to parse into, left unchanged if the schema hash does not match
+* \return Whether the data was written with the same schema as T has now. Only the hash is parsed if it was not
+*
+*/
+template<typename T>
+bool ParseReflectedWithSchemaHash(BufferParser& bufferParser, T& out_value)
+{
+	if (bufferParser.ParseUint32() != GetBufferValueTypeHash<T>())
+	{
+		return false;
+	}
+
+	ParseReflected(bufferParser, out_value);
+	return true;
+}
@@ -0,0 +1,135 @@
+#include "Engine/Core/BufferSpan.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BUFFERSPAN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+#if defined(BUFFERSPAN_USE_SSE2)
+//-----------------------------------------------------------------------------------------------
+// Reverses the bytes of every 16-bit lane
+static __m128i ReverseBytesOfShorts16(__m128i bytes)
+{
+	return _mm_or_si128(_mm_slli_epi16(bytes, 8), _mm_srli_epi16(bytes, 8));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Reverses the bytes of every 32-bit lane by swapping its two 16-bit halves and then the bytes of each half
+static __m128i ReverseBytesOfWords16(__m128i bytes)
+{
+	__m128i halvesSwapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(bytes, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+	return ReverseBytesOfShorts16(halvesSwapped);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Reverses the bytes of every 64-bit lane by reversing the order of its four 16-bit quarters and then the bytes of each quarter
+static __m128i ReverseBytesOfDWords16(__m128i bytes)
+{
+	__m128i quartersReversed = _mm_shufflehi_epi16(_mm_shufflelo_epi16(bytes, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+	return ReverseBytesOfShorts16(quartersReversed);
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Reverses the byte order of every wordSize-byte word in a block of memory, 16 bytes at a time where SSE2 is available. numBytes must be a multiple of wordSize, which must be 1, 2, 4 or 8
+void ReverseBytesOfWordsInPlace(uint8_t* bytes, size_t numBytes, size_t wordSize)
+{
+	GUARANTEE_OR_DIE(wordSize == 1 || wordSize == 2 || wordSize == 4 || wordSize == 8, "Can only reverse the bytes of 1, 2, 4 or 8 byte words");
+	GUARANTEE_OR_DIE(numBytes % wordSize == 0, "Cannot reverse the bytes of a partial word");
+
+	if (wordSize == 1)
+	{
+		return;
+	}
+
+	size_t byteIndex = 0;
+
+#if defined(BUFFERSPAN_USE_SSE2)
+	for (; byteIndex + 16 <= numBytes; byteIndex += 16)
+	{
+		__m128i* block = reinterpret_cast<__m128i*>(bytes + byteIndex);
+		__m128i blockBytes = _mm_loadu_si128(block);
+		if (wordSize == 2)
+		{
+			blockBytes = ReverseBytesOfShorts16(blockBytes);
+		}
+		else if (wordSize == 4)
+		{
+			blockBytes = ReverseBytesOfWords16(blockBytes);
+		}
+		else
+		{
+			blockBytes = ReverseBytesOfDWords16(blockBytes);
+		}
+		_mm_storeu_si128(block, blockBytes);
+	}
+#endif
+
+	for (; byteIndex < numBytes; byteIndex += wordSize)
+	{
+		for (size_t lowByteIndex = 0; lowByteIndex < wordSize / 2; lowByteIndex++)
+		{
+			uint8_t lowByte = bytes[byteIndex + lowByteIndex];
+			bytes[byteIndex + lowByteIndex] = bytes[byteIndex + wordSize - 1 - lowByteIndex];
+			bytes[byteIndex + wordSize - 1 - lowByteIndex] = lowByte;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Reverses the byte order of every word of every element in a span except the words set in unswappedWordMask, for element layouts only known at runtime. \sa BufferSpanLayout
+void ReverseSpanBytesInPlace(uint8_t* bytes, size_t elementSize, int numElements, size_t wordSize, uint64_t unswappedWordMask)
+{
+	GUARANTEE_OR_DIE(elementSize % wordSize == 0 && elementSize / wordSize <= 64, "Span elements must be made up of at most 64 whole words");
+
+	if (wordSize == 1 || numElements <= 0)
+	{
+		return;
+	}
+
+	ReverseBytesOfWordsInPlace(bytes, elementSize * static_cast<size_t>(numElements), wordSize);
+
+	// Reversing the whole span in blocks is faster than skipping words, so words that should not have been reversed are reversed back
+	if (unswappedWordMask == 0)
+	{
+		return;
+	}
+
+	for (int elementIndex = 0; elementIndex < numElements; elementIndex++)
+	{
+		uint8_t* elementBytes = bytes + elementSize * static_cast<size_t>(elementIndex);
+		for (size_t wordIndex = 0; wordIndex < elementSize / wordSize; wordIndex++)
+		{
+			if (!(unswappedWordMask & (1ull << wordIndex)))
+			{
+				continue;
+			}
+
+			switch (wordSize)
+			{
+				case 2:
+				{
+					ReverseShortBytesInPlace(elementBytes + wordIndex * wordSize);
+					break;
+				}
+				case 4:
+				{
+					ReverseWordBytesInPlace(elementBytes + wordIndex * wordSize);
+					break;
+				}
+				default:
+				{
+					ReverseDWordBytesInPlace(elementBytes + wordIndex * wordSize);
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Math/Vec4.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+//! \file BufferSpan.hpp
+
+void ReverseBytesOfWordsInPlace(uint8_t* bytes, size_t numBytes, size_t wordSize);
+void ReverseSpanBytesInPlace(uint8_t* bytes, size_t elementSize, int numElements, size_t wordSize, uint64_t unswappedWordMask);
+
+/*! \brief Describes how the bytes of a type written with BufferWriter::AppendSpan are reversed when the buffer uses the opposite endianness
+*
+* Spans are written as the raw bytes of their elements, so every type used in a span must be made up of words of the same size (WORD_SIZE bytes, 1 for types that are only bytes) with no padding. Words that are groups of bytes rather than numbers, such as the Rgba8 in a vertex, are marked in UNSWAPPED_WORD_MASK so their bytes are not reversed.
+* Arithmetic types and enums work as they are, structures must specialize this template and set IS_DEFINED.
+*
+*/
+template<typename T>
+struct BufferSpanLayout
+{
+	static constexpr bool IS_DEFINED = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+	static constexpr size_t WORD_SIZE = sizeof(T);
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+//! \cond
+// Hides the specializations for engine types from doxygen documentation
+template<>
+struct BufferSpanLayout<Rgba8>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 1;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+template<>
+struct BufferSpanLayout<Vec2>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+template<>
+struct BufferSpanLayout<Vec3>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+template<>
+struct BufferSpanLayout<Vec4>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+template<>
+struct BufferSpanLayout<IntVec2>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+template<>
+struct BufferSpanLayout<EulerAngles>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 0;
+};
+
+// The fourth word of both vertex types is the color
+template<>
+struct BufferSpanLayout<Vertex_PCU>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 1ull << 3;
+};
+
+template<>
+struct BufferSpanLayout<Vertex_PCUTBN>
+{
+	static constexpr bool IS_DEFINED = true;
+	static constexpr size_t WORD_SIZE = 4;
+	static constexpr uint64_t UNSWAPPED_WORD_MASK = 1ull << 3;
+};
+
+static_assert(sizeof(Vertex_PCU) == 24 && offsetof(Vertex_PCU, m_color) == 12, "Vertex_PCU spans must have the same layout as AppendVertexPCU");
+static_assert(sizeof(Vertex_PCUTBN) == 60 && offsetof(Vertex_PCUTBN, m_color) == 12, "Vertex_PCUTBN spans must have the same layout as its fields written one at a time");
+//! \endcond
+
+/*! \brief Reverses the byte order of every element in a span of elements of type T, as described by BufferSpanLayout<T>
+*
+* \param bytes The first byte of the span
+* \param numElements The number of elements in the span
+*
+*/
+template<typename T>
+void ReverseSpanBytesInPlace(uint8_t* bytes, int numElements)
+{
+	static_assert(BufferSpanLayout<T>::IS_DEFINED, "BufferSpanLayout must be specialized for structures used with AppendSpan or ParseSpan");
+	static_assert(sizeof(T) % BufferSpanLayout<T>::WORD_SIZE == 0, "The size of a span element must be a multiple of its word size");
+	static_assert(sizeof(T) / BufferSpanLayout<T>::WORD_SIZE <= 64, "A span element can have at most 64 words");
+
+	if constexpr (BufferSpanLayout<T>::WORD_SIZE > 1)
+	{
+		ReverseSpanBytesInPlace(bytes, sizeof(T), numElements, BufferSpanLayout<T>::WORD_SIZE, BufferSpanLayout<T>::UNSWAPPED_WORD_MASK);
+	}
+}
@@ -1,6 +1,8 @@
 #include "Engine/Core/BufferWriter.hpp"
 
+#include "Engine/Core/BufferEncoding.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 
 
 BufferWriter::BufferWriter(std::vector<uint8_t>& buffer)
@@ -238,6 +240,86 @@ void BufferWriter::AppendVertexPCU(Vertex_PCU const& vertexPCUToAppend)
 	AppendVec2(vertexPCUToAppend.m_uvTexCoords);
 }
 
+/*! \brief Appends a uint32_t as a variable-length integer
+* 
+* The value is written 7 bits at a time starting with the least significant bits (LEB128), with the high bit of each byte set when more bytes follow. Values below 128 take 1 byte and the largest values take 5. The encoding does not depend on the endian mode.
+* \param uint32ToAppend The value to append
+* 
+*/
+void BufferWriter::AppendVarUint32(uint32_t uint32ToAppend)
+{
+	while (uint32ToAppend >= 0x80)
+	{
+		m_buffer.push_back(static_cast<uint8_t>(uint32ToAppend | 0x80));
+		uint32ToAppend >>= 7;
+	}
+	m_buffer.push_back(static_cast<uint8_t>(uint32ToAppend));
+}
+
+//! Appends a uint64_t as a variable-length integer of 1 to 10 bytes \sa AppendVarUint32
+void BufferWriter::AppendVarUint64(uint64_t uint64ToAppend)
+{
+	while (uint64ToAppend >= 0x80)
+	{
+		m_buffer.push_back(static_cast<uint8_t>(uint64ToAppend | 0x80));
+		uint64ToAppend >>= 7;
+	}
+	m_buffer.push_back(static_cast<uint8_t>(uint64ToAppend));
+}
+
+//! Appends an int32_t as a zigzag-encoded variable-length integer, so values between -64 and 63 take 1 byte \sa ZigZagEncodeInt32
+void BufferWriter::AppendVarInt32(int32_t int32ToAppend)
+{
+	AppendVarUint32(ZigZagEncodeInt32(int32ToAppend));
+}
+
+void BufferWriter::AppendVarInt64(int64_t int64ToAppend)
+{
+	AppendVarUint64(ZigZagEncodeInt64(int64ToAppend));
+}
+
+/*! \brief Appends the difference between an int32_t and a previous value as a variable-length integer
+* 
+* Values that change slowly, such as IDs in increasing order or frame numbers, take 1 byte instead of 4. The parser must use the same previous value.
+* \param int32ToAppend The value to append
+* \param previousInt32 The value to append the difference from
+* 
+*/
+void BufferWriter::AppendDeltaInt32(int32_t int32ToAppend, int32_t previousInt32)
+{
+	// The difference wraps around instead of overflowing, and ParseDeltaInt32 wraps it back
+	uint32_t delta = static_cast<uint32_t>(int32ToAppend) - static_cast<uint32_t>(previousInt32);
+	AppendVarInt32(static_cast<int32_t>(delta));
+}
+
+void BufferWriter::AppendDeltaInt64(int64_t int64ToAppend, int64_t previousInt64)
+{
+	uint64_t delta = static_cast<uint64_t>(int64ToAppend) - static_cast<uint64_t>(previousInt64);
+	AppendVarInt64(static_cast<int64_t>(delta));
+}
+
+/*! \brief Appends a float in a known range quantized to numBits bits, rounded up to whole bytes
+* 
+* Use BufferBitWriter::AppendQuantizedFloat to pack values without rounding them up to whole bytes.
+* \param floatToAppend The value to append, clamped to the range
+* \param minValue The start of the range
+* \param maxValue The end of the range
+* \param numBits The number of bits of precision, from 1 to 32
+* \sa QuantizeFloat
+* 
+*/
+void BufferWriter::AppendQuantizedFloat(float floatToAppend, float minValue, float maxValue, int numBits)
+{
+	AppendUintOfSize(QuantizeFloat(floatToAppend, minValue, maxValue, numBits), GetNumBytesForBits(numBits));
+}
+
+void BufferWriter::AppendQuantizedVec3(Vec3 const& vec3ToAppend, Vec3 const& minValues, Vec3 const& maxValues, int numBits)
+{
+	AppendQuantizedFloat(vec3ToAppend.x, minValues.x, maxValues.x, numBits);
+	AppendQuantizedFloat(vec3ToAppend.y, minValues.y, maxValues.y, numBits);
+	AppendQuantizedFloat(vec3ToAppend.z, minValues.z, maxValues.z, numBits);
+}
+
 void BufferWriter::OverwriteUint32AtPosition(uint32_t uint32ToOverwriteValueWith, int positionToOverwriteAt)
 {
 	uint8_t* uint32Bytes = reinterpret_cast<uint8_t*>(&uint32ToOverwriteValueWith);
@@ -252,3 +334,16 @@ void BufferWriter::OverwriteUint32AtPosition(uint32_t uint32ToOverwriteValueWith
 	m_buffer[positionToOverwriteAt + 2] = uint32Bytes[2];
 	m_buffer[positionToOverwriteAt + 3] = uint32Bytes[3];
 }
+
+// Appends the low numBytes bytes of a uint32_t in the endian mode of the buffer
+void BufferWriter::AppendUintOfSize(uint32_t uintToAppend, int numBytes)
+{
+	GUARANTEE_OR_DIE(numBytes >= 1 && numBytes <= 4, "Can only append unsigned integers of 1 to 4 bytes");
+
+	bool isWritingBigEndian = (m_endianMode == BufferEndian::BIG) || (m_endianMode == BufferEndian::NATIVE && GetPlatformNativeEndianMode() == BufferEndian::BIG);
+	for (int byteIndex = 0; byteIndex < numBytes; byteIndex++)
+	{
+		int shiftBytes = isWritingBigEndian ? (numBytes - 1 - byteIndex) : byteIndex;
+		m_buffer.push_back(static_cast<uint8_t>(uintToAppend >> (8 * shiftBytes)));
+	}
+}
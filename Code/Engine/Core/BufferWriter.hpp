@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Engine/Core/BufferSpan.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -9,6 +10,7 @@
 #include "Engine/Math/Vec3.hpp"
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 
@@ -42,6 +44,48 @@ public:
 	void AppendEulerAngles(EulerAngles const& eulerAnglesToAppend);
 	void AppendVertexPCU(Vertex_PCU const& vertexPCUToAppend);
 
+	void AppendVarUint32(uint32_t uint32ToAppend);
+	void AppendVarUint64(uint64_t uint64ToAppend);
+	void AppendVarInt32(int32_t int32ToAppend);
+	void AppendVarInt64(int64_t int64ToAppend);
+	void AppendDeltaInt32(int32_t int32ToAppend, int32_t previousInt32);
+	void AppendDeltaInt64(int64_t int64ToAppend, int64_t previousInt64);
+	void AppendQuantizedFloat(float floatToAppend, float minValue, float maxValue, int numBits);
+	void AppendQuantizedVec3(Vec3 const& vec3ToAppend, Vec3 const& minValues, Vec3 const& maxValues, int numBits);
+
+	/*! \brief Appends an array of elements with a single copy
+	* 
+	* The elements are copied as they are laid out in memory with a single block copy, which for the engine types is the same as appending their fields one at a time, so ParseSpan and the single-element parse functions can read the result. The bytes are reversed afterwards in blocks only if the buffer uses the opposite endianness.
+	* \param elementsToAppend The first element of the array
+	* \param numElements The number of elements in the array
+	* \sa BufferSpanLayout
+	* 
+	*/
+	template<typename T>
+	void AppendSpan(T const* elementsToAppend, int numElements)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "AppendSpan can only append trivially copyable types");
+		if (numElements <= 0)
+		{
+			return;
+		}
+
+		size_t spanPosition = m_buffer.size();
+		uint8_t const* spanBytes = reinterpret_cast<uint8_t const*>(elementsToAppend);
+		m_buffer.insert(m_buffer.end(), spanBytes, spanBytes + sizeof(T) * static_cast<size_t>(numElements));
+
+		if (m_isWritingInOppositeEndianMode)
+		{
+			ReverseSpanBytesInPlace<T>(m_buffer.data() + spanPosition, numElements);
+		}
+	}
+
+	template<typename T>
+	void AppendSpan(std::vector<T> const& elementsToAppend)
+	{
+		AppendSpan(elementsToAppend.data(), static_cast<int>(elementsToAppend.size()));
+	}
+
 	void OverwriteUint32AtPosition(uint32_t uint32ToOverwriteValueWith, int positionToOverwriteAt);
 
 	int GetAppendedSize() const { return (int)m_buffer.size() - m_initialBufferSize; }
@@ -52,4 +96,7 @@ public:
 	int m_initialBufferSize = 0;
 	BufferEndian m_endianMode = BufferEndian::NATIVE;
 	bool m_isWritingInOppositeEndianMode = false;
+
+private:
+	void AppendUintOfSize(uint32_t uintToAppend, int numBytes);
 };
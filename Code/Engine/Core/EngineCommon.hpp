@@ -1,10 +1,12 @@
 #pragma once
 
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/StringUtils.hpp"
 
 #include <algorithm>
 #include <cctype>
 #include <string>
+#include <string_view>
 
 
 class DevConsole;
@@ -59,15 +61,14 @@ void ReverseDWordBytesInPlace(uint8_t* bytes);
 
 //! \cond
 // Hides this struct from doxygen documentation
+// Transparent, so maps using it can look up std::string_view and char const* keys without constructing a std::string
 struct cmpCaseInsensitive
 {
-	bool operator() (std::string const& a, std::string const& b) const
+	using is_transparent = void;
+
+	bool operator() (std::string_view a, std::string_view b) const
 	{
-		std::string lowerCaseA = a;
-		std::string lowerCaseB = b;
-		std::transform(a.begin(), a.end(), lowerCaseA.begin(), [](unsigned char c) { return static_cast<unsigned char>(std::tolower(static_cast<int>(c))); });
-		std::transform(b.begin(), b.end(), lowerCaseB.begin(), [](unsigned char c) { return static_cast<unsigned char>(std::tolower(static_cast<int>(c))); });
-		return lowerCaseA < lowerCaseB;
+		return CompareCaseInsensitive(a, b) < 0;
 	}
 };
 //! \endcond
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <vector>
+
+
+//! \file EventChannel.hpp
+
+/*! \brief A subscriber of an EventChannel, either a free function or a method bound to an object
+*
+* Methods are bound at compile time, so calling either kind of subscriber is a single call through m_invoke with no virtual dispatch or allocation.
+*
+*/
+template<typename TPayload>
+struct EventChannelSubscription
+{
+public:
+	typedef bool (*CallbackFunction)(TPayload const& payload);
+	typedef bool (*InvokeFunction)(EventChannelSubscription const& subscription, TPayload const& payload);
+
+public:
+	InvokeFunction m_invoke = nullptr;
+	CallbackFunction m_function = nullptr;
+	void* m_object = nullptr;
+};
+
+/*! \brief A typed event channel for hot events that should not go through the string-keyed EventSystem
+*
+* Subscribers receive a payload struct directly instead of EventArgs, so firing does not pack NamedProperties, hash or look up event names, or lock. Channels are declared as regular objects next to the code that fires them:
+* EventChannel<KeyPressedEvent> g_keyPressedChannel;
+* g_keyPressedChannel.Subscribe(&OnKeyPressed);
+* g_keyPressedChannel.Subscribe<&Game::OnKeyPressed>(*this);
+* g_keyPressedChannel.Fire(KeyPressedEvent{ keyCode });
+* As with the EventSystem, subscribers are called in the order they were added and returning true consumes the event so that no further subscribers are called.
+* An EventChannel is not thread-safe and must only be used from a single thread, normally the main thread. Subscribers can subscribe and unsubscribe (including themselves) while the channel is being fired, subscribers added during a Fire are first called by the next Fire.
+* Worker threads should notify the main thread through EventSystem::QueueEvent instead.
+*
+*/
+template<typename TPayload>
+class EventChannel
+{
+public:
+	typedef EventChannelSubscription<TPayload> Subscription;
+	typedef typename Subscription::CallbackFunction CallbackFunction;
+
+public:
+	~EventChannel() = default;
+	EventChannel() = default;
+	EventChannel(EventChannel const& copyFrom) = delete;
+	void operator=(EventChannel const& assignFrom) = delete;
+
+	void Subscribe(CallbackFunction function)
+	{
+		Subscription subscription;
+		subscription.m_invoke = &InvokeFunction;
+		subscription.m_function = function;
+		m_subscriptions.push_back(subscription);
+	}
+
+	//! Subscribes Method, a method of T taking a TPayload const& and returning whether the event was consumed, to be called on objectInstance
+	template<auto Method, typename T>
+	void Subscribe(T& objectInstance)
+	{
+		Subscription subscription;
+		subscription.m_invoke = &InvokeMethod<T, Method>;
+		subscription.m_object = &objectInstance;
+		m_subscriptions.push_back(subscription);
+	}
+
+	void Unsubscribe(CallbackFunction function)
+	{
+		RemoveSubscriptions(&InvokeFunction, function, nullptr);
+	}
+
+	template<auto Method, typename T>
+	void Unsubscribe(T& objectInstance)
+	{
+		RemoveSubscriptions(&InvokeMethod<T, Method>, nullptr, &objectInstance);
+	}
+
+	//! Removes every method subscription bound to objectInstance
+	template<typename T>
+	void UnsubscribeAllForObject(T& objectInstance)
+	{
+		RemoveSubscriptions(nullptr, nullptr, &objectInstance);
+	}
+
+	/*! \brief Calls every subscriber with the payload, in the order they subscribed, until one of them consumes the event
+	*
+	* \param payload The payload passed to every subscriber
+	* \return Whether a subscriber consumed the event
+	*
+	*/
+	bool Fire(TPayload const& payload)
+	{
+		bool wasConsumed = false;
+
+		m_numActiveFires++;
+		int numSubscriptions = static_cast<int>(m_subscriptions.size());
+		for (int subscriptionIndex = 0; subscriptionIndex < numSubscriptions; subscriptionIndex++)
+		{
+			// Subscriptions can be added by subscribers, so they are accessed by index rather than by reference
+			Subscription subscription = m_subscriptions[subscriptionIndex];
+			if (subscription.m_invoke && subscription.m_invoke(subscription, payload))
+			{
+				wasConsumed = true;
+				break;
+			}
+		}
+		m_numActiveFires--;
+
+		if (m_numActiveFires == 0 && m_hasRemovedSubscriptions)
+		{
+			CompactSubscriptions();
+		}
+
+		return wasConsumed;
+	}
+
+	int GetNumSubscriptions() const
+	{
+		int numSubscriptions = 0;
+		for (int subscriptionIndex = 0; subscriptionIndex < static_cast<int>(m_subscriptions.size()); subscriptionIndex++)
+		{
+			if (m_subscriptions[subscriptionIndex].m_invoke)
+			{
+				numSubscriptions++;
+			}
+		}
+		return numSubscriptions;
+	}
+
+protected:
+	static bool InvokeFunction(Subscription const& subscription, TPayload const& payload)
+	{
+		return subscription.m_function(payload);
+	}
+
+	template<typename T, auto Method>
+	static bool InvokeMethod(Subscription const& subscription, TPayload const& payload)
+	{
+		return (static_cast<T*>(subscription.m_object)->*Method)(payload);
+	}
+
+	// Removes subscriptions matching all of the non-null arguments. While the channel is being fired, subscriptions are only cleared so that the indexes of the remaining subscriptions do not change
+	void RemoveSubscriptions(typename Subscription::InvokeFunction invoke, CallbackFunction function, void* object)
+	{
+		for (int subscriptionIndex = 0; subscriptionIndex < static_cast<int>(m_subscriptions.size()); subscriptionIndex++)
+		{
+			Subscription& subscription = m_subscriptions[subscriptionIndex];
+			if (!subscription.m_invoke)
+			{
+				continue;
+			}
+			if (invoke && subscription.m_invoke != invoke)
+			{
+				continue;
+			}
+			if (function && subscription.m_function != function)
+			{
+				continue;
+			}
+			if (object && subscription.m_object != object)
+			{
+				continue;
+			}
+			subscription.m_invoke = nullptr;
+			m_hasRemovedSubscriptions = true;
+		}
+
+		if (m_numActiveFires == 0 && m_hasRemovedSubscriptions)
+		{
+			CompactSubscriptions();
+		}
+	}
+
+	void CompactSubscriptions()
+	{
+		int numKeptSubscriptions = 0;
+		for (int subscriptionIndex = 0; subscriptionIndex < static_cast<int>(m_subscriptions.size()); subscriptionIndex++)
+		{
+			if (m_subscriptions[subscriptionIndex].m_invoke)
+			{
+				m_subscriptions[numKeptSubscriptions] = m_subscriptions[subscriptionIndex];
+				numKeptSubscriptions++;
+			}
+		}
+		m_subscriptions.resize(numKeptSubscriptions);
+		m_hasRemovedSubscriptions = false;
+	}
+
+protected:
+	std::vector<Subscription> m_subscriptions;
+	int m_numActiveFires = 0;
+	bool m_hasRemovedSubscriptions = false;
+};
@@ -3,6 +3,16 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+
+//! Queued event buffer of the current thread for the EventSystem with the ID t_queuedEventBufferOwnerID, cached so QueueEvent only locks the first time a thread queues an event
+static thread_local QueuedEventBuffer* t_queuedEventBuffer = nullptr;
+static thread_local unsigned int t_queuedEventBufferOwnerID = 0;
+static std::atomic<unsigned int> s_nextEventSystemInstanceID = 1;
 
 
 /*! \brief Constructor for the EventSystem
@@ -11,25 +21,86 @@
 */
 EventSystem::EventSystem(EventSystemConfig const& config)
 	: m_config(config)
+	, m_dispatchTable(new EventDispatchTable())
+	, m_instanceID(s_nextEventSystemInstanceID++)
+	, m_isProfilingEnabled(config.m_enableProfiling)
 {
 }
 
+/*! \brief Destructor for the EventSystem
+* 
+* Deletes the current dispatch table along with every subscription still in it, any retired dispatch tables and unsubscribed subscriptions that have not been reclaimed yet, and any events that were queued but not dispatched. No thread may be firing or queueing events when the EventSystem is destroyed.
+* 
+*/
+EventSystem::~EventSystem()
+{
+	for (int bufferIndex = 0; bufferIndex < static_cast<int>(m_queuedEventBuffers.size()); bufferIndex++)
+	{
+		QueuedEventBuffer* queuedEventBuffer = m_queuedEventBuffers[bufferIndex];
+		QueuedEvent* queuedEvent = nullptr;
+		while (queuedEventBuffer->m_events.TryPop(queuedEvent))
+		{
+			delete queuedEvent;
+		}
+		for (int eventIndex = 0; eventIndex < static_cast<int>(queuedEventBuffer->m_overflowEvents.size()); eventIndex++)
+		{
+			delete queuedEventBuffer->m_overflowEvents[eventIndex];
+		}
+		while (queuedEventBuffer->m_freeEvents.TryPop(queuedEvent))
+		{
+			delete queuedEvent;
+		}
+		delete queuedEventBuffer;
+	}
+	m_queuedEventBuffers.clear();
+
+	EventDispatchTable* dispatchTable = m_dispatchTable.load();
+	for (auto subscriptionEntryIter = dispatchTable->m_subscriptionsByEventID.begin(); subscriptionEntryIter != dispatchTable->m_subscriptionsByEventID.end(); ++subscriptionEntryIter)
+	{
+		SubscriptionList& subscriberList = subscriptionEntryIter->second.m_subscriptions;
+		for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
+		{
+			delete subscriberList[subscriberIndex];
+		}
+	}
+	delete dispatchTable;
+	m_dispatchTable = nullptr;
+
+	DeleteDrainingDispatchTables();
+	m_drainingDispatchTables = m_retiredDispatchTables;
+	m_retiredDispatchTables.clear();
+	DeleteDrainingDispatchTables();
+}
+
 /*! \brief Startup method for the EventSystem
 * 
-* Currently does nothing but should be called by when the App starts
+* Registers the EventStats console command. Should be called by when the App starts
 * 
 */
 void EventSystem::Startup()
 {
+	SubscribeEventCallbackFunction("EventStats", Command_EventStats, "Prints the most frequently fired or most expensive events, type `EventStats help` for options");
 }
 
 /*! \brief Method that should be called by game code at the beginning of every frame
 * 
-* Currently does nothing but should still be called by the App at the beginning of each frame
+* Dispatches the events queued since the last frame and reclaims dispatch tables and unsubscribed subscriptions that no thread firing events can still be using. Should be called by the App at the beginning of each frame
 * 
 */
 void EventSystem::BeginFrame()
 {
+	if (IsProfilingEnabled())
+	{
+		m_profileStatsMutex.lock();
+		m_numProfiledFrames++;
+		m_profileStatsMutex.unlock();
+	}
+
+	DispatchQueuedEvents();
+
+	m_subscriptionListMutex.lock();
+	ReclaimRetiredDispatchTables();
+	m_subscriptionListMutex.unlock();
 }
 
 /*! \brief Method that should be called by game code at the end of every frame
@@ -66,9 +137,11 @@ void EventSystem::SubscribeEventCallbackFunction(std::string const& eventName, E
 	EventSubscription* subscription = new EventSubscription();
 	subscription->m_callbackFunctionPtr = functionPtr;
 	m_subscriptionListMutex.lock();
-	m_subscriptionListByEventName[eventName].push_back(subscription);
-	m_subscriptionListMutex.unlock();
+	EventDispatchTable* dispatchTable = CopyDispatchTable();
+	GetOrCreateSubscriptionList(*dispatchTable, eventName).push_back(subscription);
+	PublishDispatchTable(dispatchTable, SubscriptionList());
 	m_helpTexts[eventName] = helpText;
+	m_subscriptionListMutex.unlock();
 }
 
 /*! \brief Removes a callback function from the list of functions that should be called when an event is fired
@@ -83,15 +156,18 @@ void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName,
 {
 	m_subscriptionListMutex.lock();
 
-	auto subscriberListIter = m_subscriptionListByEventName.find(eventName);
+	EventDispatchTable* dispatchTable = CopyDispatchTable();
+	SubscriptionList* subscriberListPtr = FindSubscriptionList(*dispatchTable, EventID(eventName));
 
-	if (subscriberListIter == m_subscriptionListByEventName.end())
+	if (!subscriberListPtr)
 	{
+		delete dispatchTable;
 		m_subscriptionListMutex.unlock();
 		return;
 	}
 
-	SubscriptionList& subscriberList = subscriberListIter->second;
+	SubscriptionList removedSubscriptions;
+	SubscriptionList& subscriberList = *subscriberListPtr;
 	for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
 	{
 		EventSubscription* subscription = dynamic_cast<EventSubscription*>(subscriberList[subscriberIndex]);
@@ -101,16 +177,14 @@ void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName,
 		}
 		if (subscription->m_callbackFunctionPtr == functionPtr)
 		{
+			removedSubscriptions.push_back(subscription);
 			subscriberList.erase(subscriberList.begin() + subscriberIndex);
 			subscriberIndex--;
 		}
 	}
 
-	if (m_subscriptionListByEventName[eventName].empty())
-	{
-		m_subscriptionListByEventName.erase(eventName);
-		m_helpTexts.erase(eventName);
-	}
+	RemoveEventIfUnsubscribed(*dispatchTable, EventID(eventName));
+	PublishDispatchTable(dispatchTable, removedSubscriptions);
 
 	m_subscriptionListMutex.unlock();
 }
@@ -125,11 +199,29 @@ void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName,
 */
 void EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
 {
-	m_subscriptionListMutex.lock();
+	FireEvent(EventID(eventName), args);
+}
 
-	auto subscriberListIter = m_subscriptionListByEventName.find(eventName);
-	if (subscriberListIter == m_subscriptionListByEventName.end())
+/*! \brief Fires an event with the provided EventID, passing the provided arguments
+*
+* Looks up the event in the current dispatch table by its precomputed hash without taking a lock, so threads firing events never wait on each other or on threads subscribing and unsubscribing. Nothing is hashed or allocated, and EventIDs that still have their name only compare it once against the subscribed event's name.
+* The dispatch table read stays registered while the subscribers execute, so the table and its subscriptions stay alive even if a callback subscribes or unsubscribes.
+* Although this method is publicly visible, it should not be used. Instead, the global function ::FireEvent(EventID, EventArgs&) should be used as a safer alternative to this method.
+* \param eventID The EventID of the event to fire
+* \param args An #EventArgs structure containing arguments to pass to all functions subscribed to this event
+*
+*/
+void EventSystem::FireEvent(EventID eventID, EventArgs& args)
+{
+	unsigned int readerEpochParity = 0;
+	EventDispatchTable* dispatchTable = BeginDispatchTableRead(readerEpochParity);
+
+	SubscriptionList* subscriberListPtr = FindSubscriptionList(*dispatchTable, eventID);
+	if (!subscriberListPtr)
 	{
+		EndDispatchTableRead(readerEpochParity);
+
+		std::string eventName = eventID.GetEventName() ? eventID.GetEventName() : Stringf("Event 0x%08X", eventID.GetHash());
 		if (g_console)
 		{
 			g_console->AddLine(DevConsole::ERROR, Stringf("%s is not recognized as a command", eventName.c_str()));
@@ -138,20 +230,39 @@ void EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
 		{
 			DebuggerPrintf(Stringf("%s is not recognized as a command", eventName.c_str()).c_str());
 		}
-		m_subscriptionListMutex.unlock();
 		return;
 	}
 
-	m_subscriptionListMutex.unlock();
-
-	SubscriptionList subscriberList = subscriberListIter->second;
-	for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
+	SubscriptionList const& subscriberList = *subscriberListPtr;
+	if (IsProfilingEnabled())
 	{
-		if (subscriberList[subscriberIndex]->Execute(args))
+		HCIS const& eventName = dispatchTable->m_subscriptionsByEventID.find(eventID.GetHash())->second.m_eventName;
+		ExecuteSubscriptionsWithProfiling(eventName, subscriberList, args);
+	}
+	else
+	{
+		for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
 		{
-			break;
+			if (subscriberList[subscriberIndex]->Execute(args))
+			{
+				break;
+			}
 		}
 	}
+
+	EndDispatchTableRead(readerEpochParity);
+}
+
+/*! \brief Fires an event with the provided EventID with an empty #EventArgs structure
+*
+* Although this method is publicly visible, it should not be used. Instead, the global function ::FireEvent(EventID) should be used as a safer alternative to this method.
+* \param eventID The EventID of the event to fire
+*
+*/
+void EventSystem::FireEvent(EventID eventID)
+{
+	EventArgs emptyArgs;
+	FireEvent(eventID, emptyArgs);
 }
 
 /*! \brief Fires an event with the provided name with an empty #EventArgs structure
@@ -167,9 +278,204 @@ void EventSystem::FireEvent(std::string const& eventName)
 	FireEvent(eventName, emptyArgs);
 }
 
+/*! \brief Queues an event to be fired on the thread calling DispatchQueuedEvents (normally the main thread in BeginFrame) instead of firing it immediately
+* 
+* Worker threads can use this to notify game code without running game callbacks themselves. The event and a copy of the arguments are pushed to a lock-free buffer owned by the calling thread, so threads queueing events never wait on each other's locks; they only share an atomic counter that orders the events.
+* Dispatched events are recycled to the thread that queued them, so once a thread has queued a frame's worth of events, queueing more only allocates when the arguments do not fit inline in EventArgs.
+* Queued events are dispatched in the order they were queued across all threads.
+* \param eventName The name of the event to queue
+* \param args The arguments to fire the event with, copied when queueing
+* \param coalesceDuplicates If true, only the most recently queued coalescable instance of this event is dispatched when it has been queued more than once before the next dispatch. Use for events where only the latest state matters, such as a resize, and not for events where every instance matters, such as a character being typed
+* \sa DispatchQueuedEvents
+* 
+*/
+void EventSystem::QueueEvent(std::string const& eventName, EventArgs const& args, bool coalesceDuplicates)
+{
+	QueuedEventBuffer* queuedEventBuffer = GetCurrentThreadQueuedEventBuffer();
+	QueuedEvent* queuedEvent = nullptr;
+	if (!queuedEventBuffer->m_freeEvents.TryPop(queuedEvent))
+	{
+		queuedEvent = new QueuedEvent();
+		queuedEvent->m_ownerBuffer = queuedEventBuffer;
+	}
+
+	queuedEvent->m_eventName = eventName;
+	queuedEvent->m_eventID = EventID(queuedEvent->m_eventName.c_str());
+	queuedEvent->m_args = args;
+	queuedEvent->m_isCoalescable = coalesceDuplicates;
+	queuedEvent->m_sequenceNumber = m_nextQueuedEventSequenceNumber++;
+
+	if (!queuedEventBuffer->m_events.TryPush(queuedEvent))
+	{
+		queuedEventBuffer->m_overflowEventsMutex.lock();
+		queuedEventBuffer->m_overflowEvents.push_back(queuedEvent);
+		queuedEventBuffer->m_overflowEventsMutex.unlock();
+	}
+}
+
+/*! \brief Fires every event queued with QueueEvent since the last dispatch on the calling thread
+* 
+* Events are collected from every thread's buffer, sorted into the order they were queued and fired in a single pass. Coalescable events that were queued more than once are only fired for their most recently queued instance.
+* Events queued by callbacks during the dispatch are dispatched the next time this is called. Called by BeginFrame, so it rarely needs to be called directly.
+* \return The number of events fired
+* 
+*/
+int EventSystem::DispatchQueuedEvents()
+{
+	std::lock_guard<std::mutex> dispatchLock(m_dispatchQueuedEventsMutex);
+
+	m_queuedEventBuffersMutex.lock();
+	for (int bufferIndex = 0; bufferIndex < static_cast<int>(m_queuedEventBuffers.size()); bufferIndex++)
+	{
+		QueuedEventBuffer* queuedEventBuffer = m_queuedEventBuffers[bufferIndex];
+
+		// Only take as many events as the buffer can hold so a thread that keeps queueing cannot hold up the dispatch
+		QueuedEvent* queuedEvent = nullptr;
+		size_t numEventsToPop = queuedEventBuffer->m_events.GetCapacity();
+		for (size_t eventIndex = 0; eventIndex < numEventsToPop && queuedEventBuffer->m_events.TryPop(queuedEvent); eventIndex++)
+		{
+			m_dispatchingEvents.push_back(queuedEvent);
+		}
+
+		queuedEventBuffer->m_overflowEventsMutex.lock();
+		m_dispatchingEvents.insert(m_dispatchingEvents.end(), queuedEventBuffer->m_overflowEvents.begin(), queuedEventBuffer->m_overflowEvents.end());
+		queuedEventBuffer->m_overflowEvents.clear();
+		queuedEventBuffer->m_overflowEventsMutex.unlock();
+	}
+	m_queuedEventBuffersMutex.unlock();
+
+	if (m_dispatchingEvents.empty())
+	{
+		return 0;
+	}
+
+	std::sort(m_dispatchingEvents.begin(), m_dispatchingEvents.end(), [](QueuedEvent const* eventA, QueuedEvent const* eventB)
+	{
+		return static_cast<int>(eventA->m_sequenceNumber - eventB->m_sequenceNumber) < 0;
+	});
+
+	// Walk backwards so the most recent instance of each coalescable event is the one kept
+	std::unordered_set<unsigned int> coalescedEventHashes;
+	for (int eventIndex = static_cast<int>(m_dispatchingEvents.size()) - 1; eventIndex >= 0; eventIndex--)
+	{
+		QueuedEvent*& queuedEvent = m_dispatchingEvents[eventIndex];
+		if (queuedEvent->m_isCoalescable && !coalescedEventHashes.insert(queuedEvent->m_eventID.GetHash()).second)
+		{
+			RecycleQueuedEvent(queuedEvent);
+			queuedEvent = nullptr;
+		}
+	}
+
+	int numEventsFired = 0;
+	for (int eventIndex = 0; eventIndex < static_cast<int>(m_dispatchingEvents.size()); eventIndex++)
+	{
+		QueuedEvent* queuedEvent = m_dispatchingEvents[eventIndex];
+		if (!queuedEvent)
+		{
+			continue;
+		}
+		FireEvent(queuedEvent->m_eventID, queuedEvent->m_args);
+		RecycleQueuedEvent(queuedEvent);
+		numEventsFired++;
+	}
+	m_dispatchingEvents.clear();
+
+	return numEventsFired;
+}
+
+/*! \brief Enables or disables event profiling
+* 
+* While profiling is enabled, FireEvent times every subscriber callback and records per-event statistics, see EventProfileStats. Statistics collected so far are kept when profiling is disabled, use ResetProfileStats to clear them.
+* \param isProfilingEnabled Whether events fired from now on should be profiled
+* 
+*/
+void EventSystem::SetProfilingEnabled(bool isProfilingEnabled)
+{
+	m_isProfilingEnabled.store(isProfilingEnabled, std::memory_order_relaxed);
+}
+
+//! Clears all statistics collected while profiling, including the number of profiled frames
+void EventSystem::ResetProfileStats()
+{
+	m_profileStatsMutex.lock();
+	m_profileStatsByEventID.clear();
+	m_numProfiledFrames = 0;
+	m_profileStatsMutex.unlock();
+}
+
+/*! \brief Returns a copy of the statistics of every profiled event
+* 
+* \param sortMode The order in which the events should be returned, most expensive first
+* \return A list of statistics with one entry per event fired while profiling was enabled
+* 
+*/
+std::vector<EventProfileStats> EventSystem::GetProfileStats(EventProfileSortMode sortMode) const
+{
+	std::vector<EventProfileStats> profileStats;
+	m_profileStatsMutex.lock();
+	profileStats.reserve(m_profileStatsByEventID.size());
+	for (auto profileStatsIter = m_profileStatsByEventID.begin(); profileStatsIter != m_profileStatsByEventID.end(); ++profileStatsIter)
+	{
+		profileStats.push_back(profileStatsIter->second);
+	}
+	m_profileStatsMutex.unlock();
+
+	std::sort(profileStats.begin(), profileStats.end(), [sortMode](EventProfileStats const& statsA, EventProfileStats const& statsB)
+	{
+		switch (sortMode)
+		{
+			case EventProfileSortMode::TIME:
+			{
+				return statsA.m_totalSubscriberSeconds > statsB.m_totalSubscriberSeconds;
+			}
+			case EventProfileSortMode::ALLOCATIONS:
+			{
+				return statsA.m_numArgsHeapAllocations > statsB.m_numArgsHeapAllocations;
+			}
+			default:
+			{
+				return statsA.m_numFires > statsB.m_numFires;
+			}
+		}
+	});
+	return profileStats;
+}
+
+/*! \brief Prints the statistics of the most expensive profiled events to the console
+* 
+* Prints one line per event with the number of fires (in total and per profiled frame), the time spent in its subscribers (in total, per fire and the longest single callback) and the heap allocations owned by its EventArgs.
+* \param numEventsToPrint The maximum number of events to print
+* \param sortMode The statistic by which events are ranked
+* 
+*/
+void EventSystem::PrintProfileStats(int numEventsToPrint, EventProfileSortMode sortMode) const
+{
+	if (!g_console)
+	{
+		return;
+	}
+
+	std::vector<EventProfileStats> profileStats = GetProfileStats(sortMode);
+	m_profileStatsMutex.lock();
+	int numProfiledFrames = m_numProfiledFrames;
+	m_profileStatsMutex.unlock();
+
+	g_console->AddLine(DevConsole::INFO_MAJOR, Stringf("Event profiling is %s, %d events over %d frames", IsProfilingEnabled() ? "enabled" : "disabled", static_cast<int>(profileStats.size()), numProfiledFrames), false);
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("%-24s %10s %10s %12s %12s %12s %10s", "Event", "Fires", "Fires/Frm", "Total ms", "Avg us/Fire", "Max us/Call", "Allocs"), false);
+
+	int numEventsPrinted = static_cast<int>(profileStats.size()) < numEventsToPrint ? static_cast<int>(profileStats.size()) : numEventsToPrint;
+	for (int eventIndex = 0; eventIndex < numEventsPrinted; eventIndex++)
+	{
+		EventProfileStats const& stats = profileStats[eventIndex];
+		double firesPerFrame = numProfiledFrames > 0 ? static_cast<double>(stats.m_numFires) / static_cast<double>(numProfiledFrames) : 0.0;
+		double averageMicrosecondsPerFire = stats.m_numFires > 0 ? stats.m_totalSubscriberSeconds * 1000000.0 / static_cast<double>(stats.m_numFires) : 0.0;
+		g_console->AddLine(Rgba8::GREEN, Stringf("%-24s %10llu %10.1f %12.3f %12.3f %12.3f %10llu", stats.m_eventName.c_str(), stats.m_numFires, firesPerFrame, stats.m_totalSubscriberSeconds * 1000.0, averageMicrosecondsPerFire, stats.m_maxSubscriberSeconds * 1000000.0, stats.m_numArgsHeapAllocations), false);
+	}
+}
+
 /*! \brief Lists all registered commands to the console
 * 
-* Iterates through the list of registered commands (using m_subscriptionListByEventName) and lists them on the console by adding a line for each command. If a help text for the command is provided, the help text is also appended to the line to be displayed on the console.
+* Iterates through the list of registered commands (using m_helpTexts, which has an entry for every subscribed event) and lists them on the console by adding a line for each command. If a help text for the command is provided, the help text is also appended to the line to be displayed on the console.
 * Excludes commands used internally (WM_CHAR, WM_KEYDOWN, WM_KEYUP) from the list.
 * 
 */
@@ -180,7 +486,7 @@ void EventSystem::ListAllCommands() const
 	{
 		g_console->AddLine("For more information on commands, type `<command> help`", false);
 	}
-	for (auto command = m_subscriptionListByEventName.begin(); command != m_subscriptionListByEventName.end(); ++command)
+	for (auto command = m_helpTexts.begin(); command != m_helpTexts.end(); ++command)
 	{
 		if (!strcmp(command->first.c_str(), "WM_CHAR") ||
 			!strcmp(command->first.c_str(), "WM_KEYDOWN") ||
@@ -191,14 +497,13 @@ void EventSystem::ListAllCommands() const
 		}
 		std::string devConsoleLine = "";
 		devConsoleLine += Stringf("%-20s", command->first.c_str());
-		auto helpTextsIter = m_helpTexts.find(command->first);
-		if (helpTextsIter == m_helpTexts.end() || !strcmp(helpTextsIter->second.c_str(), ""))
+		if (!strcmp(command->second.c_str(), ""))
 		{
 			devConsoleLine += "No command information available";
 		}
 		else
 		{
-			devConsoleLine += helpTextsIter->second;
+			devConsoleLine += command->second;
 		}
 		if (g_console)
 		{
@@ -213,6 +518,310 @@ std::map<std::string, std::string, cmpCaseInsensitive> EventSystem::GetAllComman
 	return m_helpTexts;
 }
 
+/*! \brief Executes the subscriptions to an event like FireEvent does, timing every callback and recording the results in the profile stats
+* 
+* The callbacks are timed without holding any lock, the stats are updated under m_profileStatsMutex once all callbacks have returned.
+* \param eventName The name the event was subscribed with
+* \param subscriberList The subscriptions to the event
+* \param args The arguments the event was fired with
+* 
+*/
+void EventSystem::ExecuteSubscriptionsWithProfiling(HCIS const& eventName, SubscriptionList const& subscriberList, EventArgs& args)
+{
+	int numArgsHeapAllocations = args.GetNumHeapAllocations();
+	int numSubscriberCalls = 0;
+	double totalSubscriberSeconds = 0.0;
+	double maxSubscriberSeconds = 0.0;
+
+	for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
+	{
+		double subscriberStartSeconds = GetCurrentTimeSeconds();
+		bool consumedEvent = subscriberList[subscriberIndex]->Execute(args);
+		double subscriberSeconds = GetCurrentTimeSeconds() - subscriberStartSeconds;
+
+		numSubscriberCalls++;
+		totalSubscriberSeconds += subscriberSeconds;
+		if (subscriberSeconds > maxSubscriberSeconds)
+		{
+			maxSubscriberSeconds = subscriberSeconds;
+		}
+		if (consumedEvent)
+		{
+			break;
+		}
+	}
+
+	m_profileStatsMutex.lock();
+	EventProfileStats& stats = m_profileStatsByEventID[eventName.GetHash()];
+	stats.m_eventName = eventName;
+	stats.m_numFires++;
+	stats.m_numSubscriberCalls += numSubscriberCalls;
+	stats.m_totalSubscriberSeconds += totalSubscriberSeconds;
+	if (maxSubscriberSeconds > stats.m_maxSubscriberSeconds)
+	{
+		stats.m_maxSubscriberSeconds = maxSubscriberSeconds;
+	}
+	stats.m_numArgsHeapAllocations += numArgsHeapAllocations;
+	m_profileStatsMutex.unlock();
+}
+
+/*! \brief Event callback for the EventStats command
+* 
+* Prints the statistics of the most expensive events, see PrintProfileStats. Profiling is enabled automatically the first time the command is used, so statistics are available from the next time it is used.
+* \param args An #EventArgs structure with the command arguments. Supports "count" (number of events to print, defaults to 10), "sort" (fires, time or allocs), "enable" (turns profiling on or off), "reset" (clears collected statistics) and "help"
+* \return A boolean indicating whether the event was consumed
+* 
+*/
+bool EventSystem::Command_EventStats(EventArgs& args)
+{
+	if (!g_eventSystem || !g_console)
+	{
+		return false;
+	}
+
+	bool help = args.GetValue("help", false);
+	if (help)
+	{
+		g_console->AddLine("Prints per-event fire counts, subscriber times and EventArgs heap allocations", false);
+		g_console->AddLine("Parameters: count=<number of events> sort=<fires|time|allocs> enable=<true|false> reset=<true|false>", false);
+		g_console->AddLine("Example Usage: > EventStats count=5 sort=time", false);
+		return true;
+	}
+
+	if (args.GetValue("reset", false))
+	{
+		g_eventSystem->ResetProfileStats();
+	}
+
+	bool wasProfilingEnabled = g_eventSystem->IsProfilingEnabled();
+	bool isProfilingEnabled = args.GetValue("enable", true);
+	g_eventSystem->SetProfilingEnabled(isProfilingEnabled);
+	if (!wasProfilingEnabled && isProfilingEnabled)
+	{
+		g_console->AddLine(DevConsole::INFO_MAJOR, "Event profiling enabled", false);
+		return true;
+	}
+
+	EventProfileSortMode sortMode = EventProfileSortMode::FIRES;
+	std::string sortModeName = args.GetValue("sort", "fires");
+	if (!_stricmp(sortModeName.c_str(), "time"))
+	{
+		sortMode = EventProfileSortMode::TIME;
+	}
+	else if (!_stricmp(sortModeName.c_str(), "allocs"))
+	{
+		sortMode = EventProfileSortMode::ALLOCATIONS;
+	}
+
+	g_eventSystem->PrintProfileStats(args.GetValue("count", 10), sortMode);
+	return true;
+}
+
+/*! \brief Returns the subscription list for the event, adding the event to the dispatch table if it has no subscriptions yet
+* 
+* Must be called with m_subscriptionListMutex locked on a dispatch table that has not been published yet. Dies if a different event name with the same EventID hash has already been subscribed to, since the two events could not be told apart when fired by EventID.
+* \param dispatchTable The dispatch table to add the event to
+* \param eventName The name of the event
+* \return The subscription list for the event
+* 
+*/
+SubscriptionList& EventSystem::GetOrCreateSubscriptionList(EventDispatchTable& dispatchTable, std::string const& eventName)
+{
+	EventSubscriptionEntry& subscriptionEntry = dispatchTable.m_subscriptionsByEventID[HashedCaseInsensitiveString::GetHashForText(eventName)];
+	if (subscriptionEntry.m_eventName.IsEmpty())
+	{
+		subscriptionEntry.m_eventName = eventName;
+	}
+	else if (subscriptionEntry.m_eventName != eventName)
+	{
+		ERROR_AND_DIE(Stringf("Events \"%s\" and \"%s\" have the same EventID hash, one of them must be renamed", subscriptionEntry.m_eventName.c_str(), eventName.c_str()));
+	}
+
+	return subscriptionEntry.m_subscriptions;
+}
+
+/*! \brief Returns the subscription list for the event, or nullptr if nothing is subscribed to the event
+* 
+* Can be called on the published dispatch table from FireEvent between BeginDispatchTableRead and EndDispatchTableRead, or on an unpublished copy with m_subscriptionListMutex locked. If the EventID still has its name, the name is compared as well so that an unsubscribed event whose hash collides with a subscribed one is not dispatched to the wrong subscribers.
+* 
+*/
+SubscriptionList* EventSystem::FindSubscriptionList(EventDispatchTable& dispatchTable, EventID eventID)
+{
+	auto subscriptionEntryIter = dispatchTable.m_subscriptionsByEventID.find(eventID.GetHash());
+	if (subscriptionEntryIter == dispatchTable.m_subscriptionsByEventID.end())
+	{
+		return nullptr;
+	}
+
+	EventSubscriptionEntry& subscriptionEntry = subscriptionEntryIter->second;
+	// The hashes already matched in the map lookup, so only the text is compared without hashing the name again
+	if (eventID.GetEventName() && CompareCaseInsensitive(subscriptionEntry.m_eventName.c_str(), eventID.GetEventName()) != 0)
+	{
+		return nullptr;
+	}
+
+	return &subscriptionEntry.m_subscriptions;
+}
+
+//! Removes the event from an unpublished dispatch table and from the help texts if it has no subscriptions left, must be called with m_subscriptionListMutex locked
+void EventSystem::RemoveEventIfUnsubscribed(EventDispatchTable& dispatchTable, EventID eventID)
+{
+	auto subscriptionEntryIter = dispatchTable.m_subscriptionsByEventID.find(eventID.GetHash());
+	if (subscriptionEntryIter == dispatchTable.m_subscriptionsByEventID.end() || !subscriptionEntryIter->second.m_subscriptions.empty())
+	{
+		return;
+	}
+
+	m_helpTexts.erase(subscriptionEntryIter->second.m_eventName.GetOriginalString());
+	dispatchTable.m_subscriptionsByEventID.erase(subscriptionEntryIter);
+}
+
+//! Returns a new copy of the published dispatch table for a writer to modify and publish, must be called with m_subscriptionListMutex locked
+EventDispatchTable* EventSystem::CopyDispatchTable() const
+{
+	return new EventDispatchTable(*m_dispatchTable.load());
+}
+
+/*! \brief Replaces the published dispatch table with a modified copy
+* 
+* Threads that begin firing events after this see the new table. The old table and the subscriptions removed from it are retired rather than deleted since threads that were already firing events might still be reading them, and are reclaimed once that can no longer be the case.
+* Must be called with m_subscriptionListMutex locked.
+* \param newDispatchTable The modified copy returned by CopyDispatchTable, owned by the EventSystem after this call
+* \param removedSubscriptions Subscriptions that are in the published table but not in the new one, deleted together with the old table
+* 
+*/
+void EventSystem::PublishDispatchTable(EventDispatchTable* newDispatchTable, SubscriptionList const& removedSubscriptions)
+{
+	RetiredEventDispatchTable retiredDispatchTable;
+	retiredDispatchTable.m_dispatchTable = m_dispatchTable.exchange(newDispatchTable);
+	retiredDispatchTable.m_removedSubscriptions = removedSubscriptions;
+	m_retiredDispatchTables.push_back(retiredDispatchTable);
+
+	ReclaimRetiredDispatchTables();
+}
+
+/*! \brief Deletes retired dispatch tables once no thread firing events can still be reading them, without ever waiting for readers
+* 
+* Retired tables are reclaimed in batches. A batch starts draining by advancing the reader epoch, after which new readers register under the other parity and can only see tables published after the batch was retired. The batch is deleted once the readers registered under the parity it was drained from have all finished.
+* Callbacks are free to subscribe and unsubscribe while an event is being fired, so this cannot block until the readers finish. Must be called with m_subscriptionListMutex locked.
+* 
+*/
+void EventSystem::ReclaimRetiredDispatchTables()
+{
+	if (!m_drainingDispatchTables.empty())
+	{
+		if (m_numReadersByEpochParity[m_drainingEpochParity].load() != 0)
+		{
+			return;
+		}
+		DeleteDrainingDispatchTables();
+	}
+
+	if (m_retiredDispatchTables.empty())
+	{
+		return;
+	}
+
+	m_drainingDispatchTables.swap(m_retiredDispatchTables);
+	m_drainingEpochParity = m_readerEpoch.fetch_add(1) & 1;
+
+	if (m_numReadersByEpochParity[m_drainingEpochParity].load() == 0)
+	{
+		DeleteDrainingDispatchTables();
+	}
+}
+
+//! Deletes every draining dispatch table along with the subscriptions removed from it
+void EventSystem::DeleteDrainingDispatchTables()
+{
+	for (int retiredIndex = 0; retiredIndex < static_cast<int>(m_drainingDispatchTables.size()); retiredIndex++)
+	{
+		RetiredEventDispatchTable& retiredDispatchTable = m_drainingDispatchTables[retiredIndex];
+		for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(retiredDispatchTable.m_removedSubscriptions.size()); subscriberIndex++)
+		{
+			delete retiredDispatchTable.m_removedSubscriptions[subscriberIndex];
+		}
+		delete retiredDispatchTable.m_dispatchTable;
+	}
+	m_drainingDispatchTables.clear();
+}
+
+/*! \brief Registers the calling thread as a reader under the current reader epoch and returns the published dispatch table
+* 
+* The table and every subscription in it stay alive until the matching EndDispatchTableRead. Reads can be nested, such as when a callback fires another event.
+* \param out_readerEpochParity Set to the parity the reader registered under, must be passed to EndDispatchTableRead
+* \return The published dispatch table, which must not be modified
+* 
+*/
+EventDispatchTable* EventSystem::BeginDispatchTableRead(unsigned int& out_readerEpochParity)
+{
+	while (true)
+	{
+		unsigned int readerEpoch = m_readerEpoch.load();
+		out_readerEpochParity = readerEpoch & 1;
+		m_numReadersByEpochParity[out_readerEpochParity].fetch_add(1);
+
+		// If the epoch advanced before the reader registered, a writer may already have checked this parity's counter and the reader has to register under the new epoch instead
+		if (m_readerEpoch.load() == readerEpoch)
+		{
+			break;
+		}
+		m_numReadersByEpochParity[out_readerEpochParity].fetch_sub(1);
+	}
+
+	return m_dispatchTable.load();
+}
+
+//! Unregisters a reader registered by BeginDispatchTableRead
+void EventSystem::EndDispatchTableRead(unsigned int readerEpochParity)
+{
+	m_numReadersByEpochParity[readerEpochParity].fetch_sub(1);
+}
+
+//! Returns the calling thread's queued event buffer for this EventSystem, creating it the first time the thread queues an event
+QueuedEventBuffer* EventSystem::GetCurrentThreadQueuedEventBuffer()
+{
+	if (t_queuedEventBufferOwnerID == m_instanceID)
+	{
+		return t_queuedEventBuffer;
+	}
+
+	std::thread::id threadID = std::this_thread::get_id();
+	QueuedEventBuffer* queuedEventBuffer = nullptr;
+
+	m_queuedEventBuffersMutex.lock();
+	for (int bufferIndex = 0; bufferIndex < static_cast<int>(m_queuedEventBuffers.size()); bufferIndex++)
+	{
+		if (m_queuedEventBuffers[bufferIndex]->m_threadID == threadID)
+		{
+			queuedEventBuffer = m_queuedEventBuffers[bufferIndex];
+			break;
+		}
+	}
+	if (!queuedEventBuffer)
+	{
+		queuedEventBuffer = new QueuedEventBuffer(static_cast<size_t>(m_config.m_queuedEventBufferCapacity));
+		queuedEventBuffer->m_threadID = threadID;
+		m_queuedEventBuffers.push_back(queuedEventBuffer);
+	}
+	m_queuedEventBuffersMutex.unlock();
+
+	t_queuedEventBuffer = queuedEventBuffer;
+	t_queuedEventBufferOwnerID = m_instanceID;
+	return queuedEventBuffer;
+}
+
+//! Returns a dispatched event to the free list of the thread that queued it, or deletes it if that free list is full
+void EventSystem::RecycleQueuedEvent(QueuedEvent* queuedEvent)
+{
+	// The arguments are released now rather than when the event is reused, since they may own heap values
+	queuedEvent->m_args.Clear();
+	if (!queuedEvent->m_ownerBuffer->m_freeEvents.TryPush(queuedEvent))
+	{
+		delete queuedEvent;
+	}
+}
+
 /*! A global function to subscribe to an event
 * 
 * In general, only this function should be used and not the member function (EventSystem#SubscribeEventCallbackFunction). This global function ensures that an attempt to subscribe to an event does not cause crashes if the global EventSystem (g_eventSystem) has not been initialized.
@@ -262,6 +871,53 @@ void FireEvent(std::string const& eventName, EventArgs& args)
 	}
 }
 
+/*! \brief A global function to fire an event by its EventID
+* 
+* In general, only this function should be used and not the member function (EventSystem#FireEvent(EventID, EventArgs&)). This global function ensures that an attempt to fire an event does not cause crashes if the global EventSystem (g_eventSystem) has not been initialized.
+* \param eventID The EventID of the event to fire
+* \param args An #EventArgs structure containing arguments to pass to all functions subscribed to this event
+* \sa EventSystem#FireEvent(EventID, EventArgs&)
+* 
+*/
+void FireEvent(EventID eventID, EventArgs& args)
+{
+	if (g_eventSystem)
+	{
+		g_eventSystem->FireEvent(eventID, args);
+	}
+}
+
+/*! \brief A global function to fire an event by its EventID with an empty #EventArgs structure
+* 
+* \param eventID The EventID of the event to fire
+* \sa EventSystem#FireEvent(EventID)
+* 
+*/
+void FireEvent(EventID eventID)
+{
+	if (g_eventSystem)
+	{
+		g_eventSystem->FireEvent(eventID);
+	}
+}
+
+/*! \brief A global function to queue an event to be fired at the beginning of the next frame
+* 
+* In general, only this function should be used and not the member function (EventSystem#QueueEvent). This global function ensures that an attempt to queue an event does not cause crashes if the global EventSystem (g_eventSystem) has not been initialized.
+* \param eventName The name of the event to queue
+* \param args The arguments to fire the event with, copied when queueing
+* \param coalesceDuplicates If true, only the most recently queued instance of this event is fired if it is queued more than once in a frame
+* \sa EventSystem#QueueEvent
+* 
+*/
+void QueueEvent(std::string const& eventName, EventArgs const& args, bool coalesceDuplicates)
+{
+	if (g_eventSystem)
+	{
+		g_eventSystem->QueueEvent(eventName, args, coalesceDuplicates);
+	}
+}
+
 /*! \brief A global function to fire an event
 * 
 * In general, only this function should be used and not the member function (EventSystem#FireEvent(std::string const&). This global functions ensures that an attempt to fire an event does not cause crashes if the global EventSystem (g_eventSystem) has not been initialized.
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/HashedCaseInsensitiveString.hpp"
+#include "Engine/Core/MPMCQueue.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 
 //#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <mutex>
 //#include <cctype>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 //! \file EventSystem.hpp
@@ -75,13 +82,144 @@ public:
 //! An alias for a list of #EventSubscription structures
 typedef std::vector<EventSubscriptionBase*> SubscriptionList;
 
+/*! \brief A precomputed case-insensitive hash of an event name
+* 
+* Events are dispatched through a hash map keyed by the hash of their name, which is the same hash HashedCaseInsensitiveString uses. Firing an event with an EventID skips hashing the name and does not allocate, and EventIDs for fixed event names can be created at compile time:
+* static constexpr EventID EVENTID_KEY_DOWN("WM_KEYDOWN");
+* Subscribing to two different event names with the same hash is a fatal error.
+* 
+*/
+class EventID
+{
+public:
+	constexpr EventID() = default;
+	explicit constexpr EventID(char const* eventName)
+		: m_hash(HashedCaseInsensitiveString::GetHashForText(eventName))
+		, m_eventName(eventName)
+	{}
+	explicit EventID(std::string const& eventName)
+		: EventID(eventName.c_str())
+	{}
+
+	constexpr unsigned int GetHash() const { return m_hash; }
+	constexpr char const* GetEventName() const { return m_eventName; }
+
+	constexpr bool operator==(EventID const& compareTo) const { return m_hash == compareTo.m_hash; }
+	constexpr bool operator!=(EventID const& compareTo) const { return m_hash != compareTo.m_hash; }
+
+private:
+	unsigned int m_hash = 0;
+	//! Only used to guard against hash collisions and for error messages, so the name must outlive the EventID
+	char const* m_eventName = nullptr;
+};
+
+//! All subscriptions to a single event along with the event name they were subscribed with
+struct EventSubscriptionEntry
+{
+public:
+	HCIS m_eventName;
+	SubscriptionList m_subscriptions;
+};
+
+/*! \brief An immutable snapshot of all event subscriptions
+* 
+* FireEvent reads the current snapshot without taking a lock. Subscribing and unsubscribing copy the current snapshot, modify the copy and publish it in place of the old one, which is retired until no reader can still be using it.
+* 
+*/
+struct EventDispatchTable
+{
+public:
+	//! A mapping of EventID hashes to the subscriptions for that event
+	std::unordered_map<unsigned int, EventSubscriptionEntry> m_subscriptionsByEventID;
+};
+
+//! A dispatch table that has been replaced, along with the subscriptions that were removed when it was replaced. Both are deleted once no reader can still be using them
+struct RetiredEventDispatchTable
+{
+public:
+	EventDispatchTable* m_dispatchTable = nullptr;
+	SubscriptionList m_removedSubscriptions;
+};
+
+struct QueuedEventBuffer;
+
+/*! \brief An event queued with EventSystem::QueueEvent, waiting to be dispatched at the beginning of the next frame
+* 
+* m_eventID refers to the interned text of m_eventName, which stays valid for the lifetime of the process. Once dispatched, the event is returned to the free list of the buffer it was queued to so that the queueing thread can reuse it.
+* 
+*/
+struct QueuedEvent
+{
+public:
+	QueuedEventBuffer* m_ownerBuffer = nullptr;
+	HCIS m_eventName;
+	EventID m_eventID;
+	EventArgs m_args;
+	//! Order in which the event was queued across all threads
+	unsigned int m_sequenceNumber = 0;
+	//! Whether only the most recently queued instance of this event is dispatched if it was queued more than once in a frame
+	bool m_isCoalescable = false;
+};
+
+//! Events queued from a single thread. Only that thread pushes to it and only the thread dispatching queued events pops from it
+struct QueuedEventBuffer
+{
+public:
+	explicit QueuedEventBuffer(size_t capacity)
+		: m_events(capacity)
+		, m_freeEvents(capacity)
+	{}
+
+public:
+	std::thread::id m_threadID;
+	MPMCQueue<QueuedEvent*> m_events;
+	//! Only used when m_events is full
+	std::mutex m_overflowEventsMutex;
+	std::vector<QueuedEvent*> m_overflowEvents;
+	//! Dispatched events waiting to be reused by the owning thread, pushed by the dispatching thread
+	MPMCQueue<QueuedEvent*> m_freeEvents;
+};
+
+/*! \brief Statistics for one event collected while event profiling is enabled
+* 
+* Only events that had at least one subscriber when they were fired are recorded.
+* 
+*/
+struct EventProfileStats
+{
+public:
+	HCIS m_eventName;
+	//! Number of times the event was fired, including queued events when they were dispatched
+	uint64_t m_numFires = 0;
+	//! Number of subscriber callbacks executed, callbacks after one that consumed the event are not executed and not counted
+	uint64_t m_numSubscriberCalls = 0;
+	double m_totalSubscriberSeconds = 0.0;
+	//! Longest time spent in a single subscriber callback
+	double m_maxSubscriberSeconds = 0.0;
+	//! Sum over all fires of the heap allocations owned by the EventArgs the event was fired with, see NamedProperties::GetNumHeapAllocations
+	uint64_t m_numArgsHeapAllocations = 0;
+};
+
+//! Orders in which EventSystem::PrintProfileStats can list events, most expensive first
+enum class EventProfileSortMode
+{
+	FIRES,
+	TIME,
+	ALLOCATIONS,
+};
+
 /*! \brief A structure for the configuration to be used for this EventSystem
 * 
-* Currently contains nothing but still must be passed in to the EventSystem constructor
+* Must be passed in to the EventSystem constructor
 * 
 */
 struct EventSystemConfig
 {
+public:
+	//! Number of events each thread can queue with QueueEvent per frame before falling back to a locked overflow list, must be a power of two
+	int m_queuedEventBufferCapacity = 1024;
+	//! Whether events are profiled from startup, profiling can also be toggled at runtime with SetProfilingEnabled or the EventStats console command
+	bool m_enableProfiling = false;
 };
 
 /*! \brief Handles event subscriptions and firing events
@@ -90,13 +228,14 @@ struct EventSystemConfig
 * Any time a function is fired, the callback functions are called in the order they were added. If a callback function reports an event being consumed, no further callback functions are called for that event.
 * This system is especially useful for engine code to communicate with game code. Engine code can fire events in certain situations and if a game code function is subscribed to that event, it gets notified. If no functions are subscribed, firing of that event is benign.
 * The engine already provides a global EventSystem instance (g_eventSystem). However, game code must initialize this instance before it can be used.
+* Hot events fired with a fixed payload can use an EventChannel instead, which skips the name lookup and EventArgs packing.
 * 
 */
 class EventSystem
 {
 public:
 	EventSystem(EventSystemConfig const& config);
-	~EventSystem() = default;
+	~EventSystem();
 
 	void																Startup();
 	void																Shutdown();
@@ -109,9 +248,11 @@ public:
 	{
 		EventSubscription_Method<T>* subscription = new EventSubscription_Method<T>(objectInstance, methodPtr);
 		m_subscriptionListMutex.lock();
-		m_subscriptionListByEventName[eventName].push_back(subscription);
-		m_subscriptionListMutex.unlock();
+		EventDispatchTable* dispatchTable = CopyDispatchTable();
+		GetOrCreateSubscriptionList(*dispatchTable, eventName).push_back(subscription);
+		PublishDispatchTable(dispatchTable, SubscriptionList());
 		m_helpTexts[eventName] = helpText;
+		m_subscriptionListMutex.unlock();
 	}
 	
 	void																UnsubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr);
@@ -121,15 +262,18 @@ public:
 	{
 		m_subscriptionListMutex.lock();
 
-		auto subscriberListIter = m_subscriptionListByEventName.find(eventName);
+		EventDispatchTable* dispatchTable = CopyDispatchTable();
+		SubscriptionList* subscriberListPtr = FindSubscriptionList(*dispatchTable, EventID(eventName));
 
-		if (subscriberListIter == m_subscriptionListByEventName.end())
+		if (!subscriberListPtr)
 		{
+			delete dispatchTable;
 			m_subscriptionListMutex.unlock();
 			return;
 		}
 
-		SubscriptionList& subscriberList = subscriberListIter->second;
+		SubscriptionList removedSubscriptions;
+		SubscriptionList& subscriberList = *subscriberListPtr;
 		for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
 		{
 			EventSubscription_Method<T>* subscription = dynamic_cast<EventSubscription_Method<T>*>(subscriberList[subscriberIndex]);
@@ -139,16 +283,14 @@ public:
 			}
 			if (subscription->GetObjectPointer() == &objectInstance && subscription->m_method == methodPtr)
 			{
+				removedSubscriptions.push_back(subscription);
 				subscriberList.erase(subscriberList.begin() + subscriberIndex);
 				subscriberIndex--;
 			}
 		}
 
-		if (m_subscriptionListByEventName[eventName].empty())
-		{
-			m_subscriptionListByEventName.erase(eventName);
-			m_helpTexts.erase(eventName);
-		}
+		RemoveEventIfUnsubscribed(*dispatchTable, EventID(eventName));
+		PublishDispatchTable(dispatchTable, removedSubscriptions);
 
 		m_subscriptionListMutex.unlock();
 	}
@@ -157,10 +299,12 @@ public:
 	void UnsubscribeAllEventCallbackFunctionsForObject(T& objectInstance)
 	{
 		m_subscriptionListMutex.lock();
-		for (auto subscriptionListIter = m_subscriptionListByEventName.begin(); subscriptionListIter != m_subscriptionListByEventName.end();)
+		EventDispatchTable* dispatchTable = CopyDispatchTable();
+		SubscriptionList removedSubscriptions;
+		for (auto subscriptionListIter = dispatchTable->m_subscriptionsByEventID.begin(); subscriptionListIter != dispatchTable->m_subscriptionsByEventID.end();)
 		{
-			SubscriptionList& subscriberList = subscriptionListIter->second;
-			std::string eventName = subscriptionListIter->first;
+			SubscriptionList& subscriberList = subscriptionListIter->second.m_subscriptions;
+			std::string eventName = subscriptionListIter->second.m_eventName.GetOriginalString();
 			for (int subscriberIndex = 0; subscriberIndex < static_cast<int>(subscriberList.size()); subscriberIndex++)
 			{
 				//EventSubscription_Method<T>* subscription = dynamic_cast<EventSubscription_Method<T>*>(subscriberList[subscriberIndex]);
@@ -171,13 +315,14 @@ public:
 
 				if (subscriberList[subscriberIndex]->IsMethodSubscription() && subscriberList[subscriberIndex]->GetObjectPointer() == &objectInstance)
 				{
+					removedSubscriptions.push_back(subscriberList[subscriberIndex]);
 					subscriberList.erase(subscriberList.begin() + subscriberIndex);
 					subscriberIndex--;
 				}
 			}
-			if (m_subscriptionListByEventName[eventName].empty())
+			if (subscriberList.empty())
 			{
-				subscriptionListIter = m_subscriptionListByEventName.erase(subscriptionListIter);
+				subscriptionListIter = dispatchTable->m_subscriptionsByEventID.erase(subscriptionListIter);
 				m_helpTexts.erase(eventName);
 			}
 			else
@@ -186,23 +331,86 @@ public:
 			}
 		}
 
+		if (removedSubscriptions.empty())
+		{
+			delete dispatchTable;
+		}
+		else
+		{
+			PublishDispatchTable(dispatchTable, removedSubscriptions);
+		}
 		m_subscriptionListMutex.unlock();
 	}
 	
 	void																FireEvent(std::string const& eventName, EventArgs& args);
 	void																FireEvent(std::string const& eventName);
+	void																FireEvent(EventID eventID, EventArgs& args);
+	void																FireEvent(EventID eventID);
+
+	void																QueueEvent(std::string const& eventName, EventArgs const& args, bool coalesceDuplicates = false);
+	int																	DispatchQueuedEvents();
+
+	void																SetProfilingEnabled(bool isProfilingEnabled);
+	bool																IsProfilingEnabled() const { return m_isProfilingEnabled.load(std::memory_order_relaxed); }
+	void																ResetProfileStats();
+	std::vector<EventProfileStats>										GetProfileStats(EventProfileSortMode sortMode) const;
+	void																PrintProfileStats(int numEventsToPrint, EventProfileSortMode sortMode) const;
 
 	void																ListAllCommands() const;
 	std::map<std::string, std::string, cmpCaseInsensitive>				GetAllCommandsList() const;
 
+protected:
+	SubscriptionList&													GetOrCreateSubscriptionList(EventDispatchTable& dispatchTable, std::string const& eventName);
+	SubscriptionList*													FindSubscriptionList(EventDispatchTable& dispatchTable, EventID eventID);
+	void																RemoveEventIfUnsubscribed(EventDispatchTable& dispatchTable, EventID eventID);
+
+	EventDispatchTable*													CopyDispatchTable() const;
+	void																PublishDispatchTable(EventDispatchTable* newDispatchTable, SubscriptionList const& removedSubscriptions);
+	void																ReclaimRetiredDispatchTables();
+	void																DeleteDrainingDispatchTables();
+	EventDispatchTable*													BeginDispatchTableRead(unsigned int& out_readerEpochParity);
+	void																EndDispatchTableRead(unsigned int readerEpochParity);
+
+	QueuedEventBuffer*													GetCurrentThreadQueuedEventBuffer();
+	void																RecycleQueuedEvent(QueuedEvent* queuedEvent);
+
+	void																ExecuteSubscriptionsWithProfiling(HCIS const& eventName, SubscriptionList const& subscriberList, EventArgs& args);
+
+	static bool															Command_EventStats(EventArgs& args);
+
 protected:
 	//! The configuration used for this EventSystem
 	EventSystemConfig													m_config;
+	//! Serializes writers (subscribing and unsubscribing) and guards m_helpTexts and the retired dispatch tables. FireEvent never takes it
 	mutable std::mutex													m_subscriptionListMutex;
-	//! A mapping of event names to a #SubscriptionList, uses the case-insensitive comparator for event names
-	std::map<std::string, SubscriptionList, cmpCaseInsensitive>			m_subscriptionListByEventName;
+	//! The current dispatch table, readers load it without locking and must never modify it
+	std::atomic<EventDispatchTable*>									m_dispatchTable = nullptr;
 	//! A mapping of event names to help texts, uses the case-insensitive comparator for event names
 	std::map<std::string, std::string, cmpCaseInsensitive>				m_helpTexts;
+
+	//! Readers register in the counter for the parity of the current epoch. Retired tables are deleted once the epoch has moved on and the counter they could still be read under drops to zero
+	std::atomic<unsigned int>											m_readerEpoch = 0;
+	std::atomic<int>													m_numReadersByEpochParity[2] = {};
+	std::vector<RetiredEventDispatchTable>								m_retiredDispatchTables;
+	std::vector<RetiredEventDispatchTable>								m_drainingDispatchTables;
+	unsigned int														m_drainingEpochParity = 0;
+
+	//! Distinguishes EventSystems for the per-thread queued event buffer caches, since a new EventSystem can be created at the address of a destroyed one
+	unsigned int														m_instanceID = 0;
+	//! One buffer for every thread that has queued an event, buffers of threads that have exited are kept until the EventSystem is destroyed
+	std::mutex															m_queuedEventBuffersMutex;
+	std::vector<QueuedEventBuffer*>										m_queuedEventBuffers;
+	std::atomic<unsigned int>											m_nextQueuedEventSequenceNumber = 0;
+	//! Only one thread dispatches queued events at a time. The list is kept between frames so dispatching does not allocate once it has grown
+	std::mutex															m_dispatchQueuedEventsMutex;
+	std::vector<QueuedEvent*>											m_dispatchingEvents;
+
+	//! Checked once per FireEvent, so firing events costs a single relaxed load while profiling is disabled
+	std::atomic<bool>													m_isProfilingEnabled = false;
+	//! Guards the profile stats, which are updated once per profiled fire after all subscribers have been executed
+	mutable std::mutex													m_profileStatsMutex;
+	std::unordered_map<unsigned int, EventProfileStats>					m_profileStatsByEventID;
+	int																	m_numProfiledFrames = 0;
 };
 
 
@@ -238,6 +446,9 @@ void UnsubscribeAllEventCallbackFunctionsForObject(T& objectInstance)
 void UnsubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr);
 void FireEvent(std::string const& eventName, EventArgs& args);
 void FireEvent(std::string const& eventStr);
+void FireEvent(EventID eventID, EventArgs& args);
+void FireEvent(EventID eventID);
+void QueueEvent(std::string const& eventName, EventArgs const& args, bool coalesceDuplicates = false);
 
 class EventRecipient
 {
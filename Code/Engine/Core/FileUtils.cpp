@@ -28,12 +28,7 @@ int FileReadToBuffer(std::vector<uint8_t>& out_buffer, std::string const& filena
 	}
 
 	fseek(filePtr, 0, SEEK_SET);
-	//fread(out_buffer, sizeof(uint8_t), fileSize, filePtr);
-
-	for (size_t i = 0; i < fileSize; i++)
-	{
-		out_buffer[i] = static_cast<uint8_t>(fgetc(filePtr));
-	}
+	fread(out_buffer.data(), sizeof(uint8_t), fileSize, filePtr);
 
 	fclose(filePtr);
 
@@ -146,3 +141,95 @@ bool IsFileReadOnly(std::string const& filename)
 	}
 	return (fileAttributes & FILE_ATTRIBUTE_READONLY) != 0;
 }
+
+bool GetFileLastWriteTime(uint64_t& out_lastWriteTime, std::string const& filename)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fileAttributeData;
+	if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &fileAttributeData))
+	{
+		return false;
+	}
+
+	out_lastWriteTime = (static_cast<uint64_t>(fileAttributeData.ftLastWriteTime.dwHighDateTime) << 32) | static_cast<uint64_t>(fileAttributeData.ftLastWriteTime.dwLowDateTime);
+	return true;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+/*! \brief Maps a file into memory for reading, closing any file that was previously open
+* 
+* \param filename The path of the file, relative to the location of the game executable
+* \return A boolean indicating whether the file was mapped. Empty files can be opened but have no data
+* 
+*/
+bool MemoryMappedFile::Open(std::string const& filename)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	m_fileHandle = fileHandle;
+	m_isOpen = true;
+
+	// Files of size 0 cannot be mapped
+	if (fileSize.QuadPart == 0)
+	{
+		return true;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mappingHandle)
+	{
+		Close();
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+
+	void* mappedView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!mappedView)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<uint8_t const*>(mappedView);
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+//! Unmaps the file and closes it. Any pointers to its data become invalid
+void MemoryMappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+
+	m_isOpen = false;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
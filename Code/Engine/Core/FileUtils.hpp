@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -71,3 +72,42 @@ int ListAllFilesInDirectory(std::string directory, std::vector<std::string>& out
 std::string RunCommand(std::string const& command);
 
 bool IsFileReadOnly(std::string const& filename);
+
+/*! \brief Gets the time at which a file was last written to
+*
+* \param out_lastWriteTime The last write time of the file, in 100-nanosecond intervals since January 1, 1601 (UTC)
+* \param filename The path of the file, relative to the location of the game executable
+* \return A boolean indicating whether the file exists and its last write time could be read
+*
+*/
+bool GetFileLastWriteTime(uint64_t& out_lastWriteTime, std::string const& filename);
+
+/*! \brief A read-only view of a file mapped into memory
+* 
+* Pages of the file are loaded by the operating system when they are first read instead of the whole file being copied into a buffer up front, so large files such as save files and model caches can be parsed in place by a BufferParser created over GetData and GetSize.
+* The view stays valid until the file is closed or the MemoryMappedFile is destroyed.
+* 
+*/
+class MemoryMappedFile
+{
+public:
+	~MemoryMappedFile();
+	MemoryMappedFile() = default;
+	MemoryMappedFile(MemoryMappedFile const& copyFrom) = delete;
+	void operator=(MemoryMappedFile const& assignFrom) = delete;
+
+	bool			Open(std::string const& filename);
+	void			Close();
+
+	bool			IsOpen() const { return m_isOpen; }
+	uint8_t const*	GetData() const { return m_data; }
+	size_t			GetSize() const { return m_size; }
+
+private:
+	bool			m_isOpen = false;
+	//! Operating system handles of the file and of its mapping, stored as void* so the header does not depend on windows.h
+	void*			m_fileHandle = nullptr;
+	void*			m_mappingHandle = nullptr;
+	uint8_t const*	m_data = nullptr;
+	size_t			m_size = 0;
+};
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "Engine/Core/HashedCaseInsensitiveString.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/*! \brief A hash map keyed by case-insensitive strings that uses the hash HashedCaseInsensitiveString already stores
+*
+* Entries are stored densely in a vector, and an open-addressing table with linear probing maps hashes to entry indexes. Probing only touches the 8-byte slots, which hold the full hash, so keys are only compared when their hashes match.
+* Looking up a key by std::string or char const* hashes the text without constructing a HashedCaseInsensitiveString, so lookups do not intern the text. Looking up an HCIS compares StringIDs instead of text.
+* Entries can be iterated in insertion order as long as nothing has been removed. Removing an entry moves the last entry into its place. Adding or removing entries invalidates pointers to values.
+*
+*/
+template<typename T>
+class HCISMap
+{
+public:
+	struct Entry
+	{
+	public:
+		HCIS m_key;
+		T m_value = T();
+	};
+
+public:
+	~HCISMap() = default;
+	HCISMap() = default;
+
+	int GetSize() const { return static_cast<int>(m_entries.size()); }
+	bool IsEmpty() const { return m_entries.empty(); }
+
+	T* Find(HCIS const& key)
+	{
+		int slotIndex = FindSlotIndex(key);
+		return slotIndex < 0 ? nullptr : &m_entries[m_slots[slotIndex].m_entryIndex - 1].m_value;
+	}
+	T* Find(std::string const& key) { return FindWithHash(HCIS::GetHashForText(key.c_str()), key.c_str()); }
+	T* Find(char const* key) { return FindWithHash(HCIS::GetHashForText(key), key); }
+	T const* Find(HCIS const& key) const { return const_cast<HCISMap*>(this)->Find(key); }
+	T const* Find(std::string const& key) const { return const_cast<HCISMap*>(this)->Find(key); }
+	T const* Find(char const* key) const { return const_cast<HCISMap*>(this)->Find(key); }
+
+	bool Contains(std::string const& key) const { return Find(key) != nullptr; }
+
+	//! Returns the value for the key, adding a default constructed value if the key is not in the map
+	T& operator[](HCIS const& key)
+	{
+		T* value = Find(key);
+		if (value)
+		{
+			return *value;
+		}
+		return AddNewEntry(key);
+	}
+
+	T& operator[](std::string const& key)
+	{
+		T* value = Find(key);
+		if (value)
+		{
+			return *value;
+		}
+		return AddNewEntry(HCIS(key));
+	}
+
+	T& operator[](char const* key)
+	{
+		T* value = Find(key);
+		if (value)
+		{
+			return *value;
+		}
+		return AddNewEntry(HCIS(key));
+	}
+
+	void Set(HCIS const& key, T const& value)
+	{
+		(*this)[key] = value;
+	}
+
+	//! Removes the entry with the key, returning whether there was one
+	bool Remove(std::string const& key)
+	{
+		unsigned int hash = HCIS::GetHashForText(key.c_str());
+		int slotIndex = FindSlotIndex(hash, key.c_str());
+		if (slotIndex < 0)
+		{
+			return false;
+		}
+
+		int entryIndex = m_slots[slotIndex].m_entryIndex - 1;
+		RemoveSlot(slotIndex);
+
+		// Move the last entry into the removed entry's place and point its slot at the new index
+		int lastEntryIndex = static_cast<int>(m_entries.size()) - 1;
+		if (entryIndex != lastEntryIndex)
+		{
+			Entry& lastEntry = m_entries[lastEntryIndex];
+			int lastEntrySlotIndex = FindSlotIndex(lastEntry.m_key);
+			m_slots[lastEntrySlotIndex].m_entryIndex = entryIndex + 1;
+			m_entries[entryIndex] = std::move(lastEntry);
+		}
+		m_entries.pop_back();
+		return true;
+	}
+
+	void Clear()
+	{
+		m_entries.clear();
+		m_slots.clear();
+	}
+
+	//! Makes room for numEntries entries so that adding them does not grow the table
+	void Reserve(int numEntries)
+	{
+		m_entries.reserve(numEntries);
+		int numSlots = MIN_NUM_SLOTS;
+		while (numSlots * MAX_LOAD_NUMERATOR < numEntries * MAX_LOAD_DENOMINATOR)
+		{
+			numSlots *= 2;
+		}
+		if (numSlots > static_cast<int>(m_slots.size()))
+		{
+			Rehash(numSlots);
+		}
+	}
+
+	Entry const& GetEntry(int entryIndex) const { return m_entries[entryIndex]; }
+	Entry& GetEntry(int entryIndex) { return m_entries[entryIndex]; }
+	typename std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+	typename std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+	typename std::vector<Entry>::iterator begin() { return m_entries.begin(); }
+	typename std::vector<Entry>::iterator end() { return m_entries.end(); }
+
+protected:
+	struct Slot
+	{
+	public:
+		unsigned int m_hash = 0;
+		//! One more than the index of the entry in m_entries, 0 for an empty slot
+		int m_entryIndex = 0;
+	};
+
+	// Keys that are already interned compare by their case-insensitive StringIDs instead of their text
+	int FindSlotIndex(HCIS const& key) const
+	{
+		if (m_slots.empty())
+		{
+			return -1;
+		}
+
+		unsigned int hash = key.GetHash();
+		unsigned int slotMask = static_cast<unsigned int>(m_slots.size()) - 1;
+		for (unsigned int slotIndex = hash & slotMask; ; slotIndex = (slotIndex + 1) & slotMask)
+		{
+			Slot const& slot = m_slots[slotIndex];
+			if (slot.m_entryIndex == 0)
+			{
+				return -1;
+			}
+			if (slot.m_hash == hash && m_entries[slot.m_entryIndex - 1].m_key == key)
+			{
+				return static_cast<int>(slotIndex);
+			}
+		}
+	}
+
+	T* FindWithHash(unsigned int hash, char const* key)
+	{
+		int slotIndex = FindSlotIndex(hash, key);
+		if (slotIndex < 0)
+		{
+			return nullptr;
+		}
+		return &m_entries[m_slots[slotIndex].m_entryIndex - 1].m_value;
+	}
+
+	int FindSlotIndex(unsigned int hash, char const* key) const
+	{
+		if (m_slots.empty())
+		{
+			return -1;
+		}
+
+		unsigned int slotMask = static_cast<unsigned int>(m_slots.size()) - 1;
+		for (unsigned int slotIndex = hash & slotMask; ; slotIndex = (slotIndex + 1) & slotMask)
+		{
+			Slot const& slot = m_slots[slotIndex];
+			if (slot.m_entryIndex == 0)
+			{
+				return -1;
+			}
+			if (slot.m_hash == hash && !_stricmp(m_entries[slot.m_entryIndex - 1].m_key.c_str(), key))
+			{
+				return static_cast<int>(slotIndex);
+			}
+		}
+	}
+
+	T& AddNewEntry(HCIS const& key)
+	{
+		if ((static_cast<int>(m_entries.size()) + 1) * MAX_LOAD_DENOMINATOR > static_cast<int>(m_slots.size()) * MAX_LOAD_NUMERATOR)
+		{
+			Rehash(m_slots.empty() ? MIN_NUM_SLOTS : static_cast<int>(m_slots.size()) * 2);
+		}
+
+		Entry newEntry;
+		newEntry.m_key = key;
+		m_entries.push_back(newEntry);
+		InsertSlot(key.GetHash(), static_cast<int>(m_entries.size()));
+		return m_entries.back().m_value;
+	}
+
+	void InsertSlot(unsigned int hash, int entryIndexPlusOne)
+	{
+		unsigned int slotMask = static_cast<unsigned int>(m_slots.size()) - 1;
+		unsigned int slotIndex = hash & slotMask;
+		while (m_slots[slotIndex].m_entryIndex != 0)
+		{
+			slotIndex = (slotIndex + 1) & slotMask;
+		}
+		m_slots[slotIndex].m_hash = hash;
+		m_slots[slotIndex].m_entryIndex = entryIndexPlusOne;
+	}
+
+	// Backward shift deletion, moves later slots of the same probe run back so that lookups never need tombstones
+	void RemoveSlot(int removedSlotIndex)
+	{
+		unsigned int slotMask = static_cast<unsigned int>(m_slots.size()) - 1;
+		unsigned int emptySlotIndex = static_cast<unsigned int>(removedSlotIndex);
+		unsigned int slotIndex = emptySlotIndex;
+		while (true)
+		{
+			slotIndex = (slotIndex + 1) & slotMask;
+			Slot& slot = m_slots[slotIndex];
+			if (slot.m_entryIndex == 0)
+			{
+				break;
+			}
+
+			// A slot can fill the gap only if its home slot is not between the gap and the slot itself
+			unsigned int homeSlotIndex = slot.m_hash & slotMask;
+			unsigned int distanceFromHome = (slotIndex - homeSlotIndex) & slotMask;
+			unsigned int distanceFromGap = (slotIndex - emptySlotIndex) & slotMask;
+			if (distanceFromHome >= distanceFromGap)
+			{
+				m_slots[emptySlotIndex] = slot;
+				emptySlotIndex = slotIndex;
+			}
+		}
+		m_slots[emptySlotIndex] = Slot();
+	}
+
+	void Rehash(int numSlots)
+	{
+		m_slots.assign(numSlots, Slot());
+		for (int entryIndex = 0; entryIndex < static_cast<int>(m_entries.size()); entryIndex++)
+		{
+			InsertSlot(m_entries[entryIndex].m_key.GetHash(), entryIndex + 1);
+		}
+	}
+
+protected:
+	//! The table grows once it is more than 3/4 full
+	static constexpr int MAX_LOAD_NUMERATOR = 3;
+	static constexpr int MAX_LOAD_DENOMINATOR = 4;
+	static constexpr int MIN_NUM_SLOTS = 16;
+
+	std::vector<Entry> m_entries;
+	std::vector<Slot> m_slots;
+};
@@ -1,129 +1,102 @@
 #include "Engine/Core/HashedCaseInsensitiveString.hpp"
 
+#include "Engine/Core/StringUtils.hpp"
 
-HashedCaseInsensitiveString::HashedCaseInsensitiveString(char const* text)
-	: m_originalStr(text)
-	, m_caseInsensitiveHash(GetHashForText(text))
-{
-}
 
-HashedCaseInsensitiveString::HashedCaseInsensitiveString(std::string text)
-	: HashedCaseInsensitiveString(text.c_str())
+HashedCaseInsensitiveString::HashedCaseInsensitiveString(char const* text)
 {
+	SetText(text);
 }
 
-unsigned int HashedCaseInsensitiveString::GetHashForText(char const* text)
+HashedCaseInsensitiveString::HashedCaseInsensitiveString(std::string const& text)
 {
-	unsigned int hash = 0;
-
-	for (char const* scan = text; *scan != '\0'; ++scan)
-	{
-		hash *= 31;
-		hash += (unsigned int)std::tolower(*scan);
-	}
-
-	return hash;
+	SetText(text);
 }
 
 unsigned int HashedCaseInsensitiveString::GetHashForText(std::string const& text)
 {
-	return GetHashForText(text.c_str());
+	return GetHashForText(std::string_view(text));
 }
 
+// Orders by hash first, strings with the same hash are ordered by their case-insensitive IDs. The order is consistent with operator== but is not alphabetical
 bool HashedCaseInsensitiveString::operator<(HashedCaseInsensitiveString const& hcisToCompare) const
 {
-	if (m_caseInsensitiveHash < hcisToCompare.m_caseInsensitiveHash)
-	{
-		return true;
-	}
-
-	if (m_caseInsensitiveHash > hcisToCompare.m_caseInsensitiveHash)
+	if (m_caseInsensitiveHash != hcisToCompare.m_caseInsensitiveHash)
 	{
-		return false;
+		return m_caseInsensitiveHash < hcisToCompare.m_caseInsensitiveHash;
 	}
 
-	return _stricmp(m_originalStr.c_str(), hcisToCompare.m_originalStr.c_str()) < 0 ? true : false;
+	return m_caseInsensitiveStringID < hcisToCompare.m_caseInsensitiveStringID;
 }
 
 bool HashedCaseInsensitiveString::operator>(HashedCaseInsensitiveString const& hcisToCompare) const
 {
-	if (m_caseInsensitiveHash > hcisToCompare.m_caseInsensitiveHash)
-	{
-		return true;
-	}
-
-	if (m_caseInsensitiveHash < hcisToCompare.m_caseInsensitiveHash)
-	{
-		return false;
-	}
-
-	return _stricmp(m_originalStr.c_str(), hcisToCompare.m_originalStr.c_str()) > 0 ? true : false;
+	return hcisToCompare < *this;
 }
 
 bool HashedCaseInsensitiveString::operator==(HashedCaseInsensitiveString const& hcisToCompare) const
 {
-	if (m_caseInsensitiveHash != hcisToCompare.m_caseInsensitiveHash)
-	{
-		return false;
-	}
-
-	return _stricmp(m_originalStr.c_str(), hcisToCompare.m_originalStr.c_str()) == 0 ? true : false;
+	return m_caseInsensitiveStringID == hcisToCompare.m_caseInsensitiveStringID;
 }
 
 bool HashedCaseInsensitiveString::operator!=(HashedCaseInsensitiveString const& hcisToCompare) const
 {
-	if (m_caseInsensitiveHash != hcisToCompare.m_caseInsensitiveHash)
-	{
-		return true;
-	}
-
-	return _stricmp(m_originalStr.c_str(), hcisToCompare.m_originalStr.c_str()) != 0 ? true : false;
+	return m_caseInsensitiveStringID != hcisToCompare.m_caseInsensitiveStringID;
 }
 
+// Comparing with text that has not been interned compares hashes first and only compares the text if they match, so the text is not added to the StringPool
 bool HashedCaseInsensitiveString::operator==(char const* strToCompare) const
 {
-	return m_caseInsensitiveHash == GetHashForText(strToCompare);
-}
-
-bool HashedCaseInsensitiveString::operator!=(char const* strToCompare) const
-{
-	if (m_caseInsensitiveHash == GetHashForText(strToCompare))
+	if (m_caseInsensitiveHash != GetHashForText(strToCompare))
 	{
 		return false;
 	}
 
-	return _stricmp(m_originalStr.c_str(), strToCompare) != 0 ? true : false;
+	return CompareCaseInsensitive(c_str(), strToCompare) == 0;
 }
 
-bool HashedCaseInsensitiveString::operator==(std::string strToCompare) const
+bool HashedCaseInsensitiveString::operator!=(char const* strToCompare) const
 {
-	return m_caseInsensitiveHash == GetHashForText(strToCompare);
+	return !(*this == strToCompare);
 }
 
-bool HashedCaseInsensitiveString::operator!=(std::string strToCompare) const
+bool HashedCaseInsensitiveString::operator==(std::string const& strToCompare) const
 {
-	if (m_caseInsensitiveHash == GetHashForText(strToCompare))
+	if (m_caseInsensitiveHash != GetHashForText(strToCompare))
 	{
 		return false;
 	}
 
-	return _stricmp(m_originalStr.c_str(), strToCompare.c_str()) != 0 ? true : false;
+	return CompareCaseInsensitive(std::string_view(c_str(), GetLength()), strToCompare) == 0;
+}
+
+bool HashedCaseInsensitiveString::operator!=(std::string const& strToCompare) const
+{
+	return !(*this == strToCompare);
 }
 
 void HashedCaseInsensitiveString::operator=(HashedCaseInsensitiveString const& assignFrom)
 {
+	m_stringID = assignFrom.m_stringID;
+	m_caseInsensitiveStringID = assignFrom.m_caseInsensitiveStringID;
 	m_caseInsensitiveHash = assignFrom.m_caseInsensitiveHash;
-	m_originalStr = assignFrom.m_originalStr;
 }
 
 void HashedCaseInsensitiveString::operator=(char const* text)
 {
-	m_originalStr = text;
-	m_caseInsensitiveHash = GetHashForText(text);
+	SetText(text);
 }
 
 void HashedCaseInsensitiveString::operator=(std::string const& text)
 {
-	m_originalStr = text;
-	m_caseInsensitiveHash = GetHashForText(text);
+	SetText(text);
+}
+
+// Interns the text, the hash and case-insensitive ID are looked up from the StringPool rather than recomputed
+void HashedCaseInsensitiveString::SetText(std::string_view text)
+{
+	StringPool& stringPool = StringPool::GetInstance();
+	m_stringID = stringPool.Intern(text);
+	m_caseInsensitiveStringID = stringPool.GetCaseInsensitiveID(m_stringID);
+	m_caseInsensitiveHash = stringPool.GetCaseInsensitiveHash(m_stringID);
 }
@@ -1,22 +1,37 @@
 #pragma once
 
+#include "Engine/Core/StringPool.hpp"
+
 #include <string>
+#include <string_view>
 
 
+/*! \brief A case-insensitive string that compares as integers
+*
+* The text is interned in the process-wide StringPool, so an HCIS only holds the StringID of its original spelling, the StringID of its case-insensitive equivalent and the case-insensitive hash. Copying one does not allocate, equal keys share their storage, and two HCISs are equal exactly when their case-insensitive IDs are.
+*
+*/
 typedef class HashedCaseInsensitiveString
 {
 public:
 	HashedCaseInsensitiveString() = default;
 	HashedCaseInsensitiveString(HashedCaseInsensitiveString const& copyFrom) = default;
 	HashedCaseInsensitiveString(char const* text);
-	HashedCaseInsensitiveString(std::string text);
+	HashedCaseInsensitiveString(std::string const& text);
 
-	static unsigned int GetHashForText(char const* text);
+	static constexpr unsigned int GetHashForText(std::string_view text);
+	static constexpr unsigned int GetHashForText(char const* text);
 	static unsigned int GetHashForText(std::string const& text);
 
 	unsigned int GetHash() const { return m_caseInsensitiveHash; }
-	std::string const& GetOriginalString() const { m_originalStr; }
-	char const* c_str() const { return m_originalStr.c_str(); }
+	//! ID of the text with its original capitalization
+	StringID GetStringID() const { return m_stringID; }
+	//! ID shared by every capitalization of the text
+	StringID GetCaseInsensitiveStringID() const { return m_caseInsensitiveStringID; }
+	std::string GetOriginalString() const { return std::string(c_str(), GetLength()); }
+	char const* c_str() const { return StringPool::GetInstance().GetText(m_stringID); }
+	int GetLength() const { return static_cast<int>(StringPool::GetInstance().GetLength(m_stringID)); }
+	bool IsEmpty() const { return m_stringID == STRINGID_EMPTY; }
 
 	bool operator<(HashedCaseInsensitiveString const& hcisToCompare) const;
 	bool operator>(HashedCaseInsensitiveString const& hcisToCompare) const;
@@ -24,13 +39,38 @@ public:
 	bool operator!=(HashedCaseInsensitiveString const& hcisToCompare) const;
 	bool operator==(char const* strToCompare) const;
 	bool operator!=(char const* strToCompare) const;
-	bool operator==(std::string strToCompare) const;
-	bool operator!=(std::string strToCompare) const;
+	bool operator==(std::string const& strToCompare) const;
+	bool operator!=(std::string const& strToCompare) const;
 	void operator=(HashedCaseInsensitiveString const& assignFrom);
 	void operator=(char const* text);
 	void operator=(std::string const& text);
 
 private:
-	std::string m_originalStr;
+	void SetText(std::string_view text);
+
+private:
+	StringID m_stringID = STRINGID_EMPTY;
+	StringID m_caseInsensitiveStringID = STRINGID_EMPTY;
 	unsigned int m_caseInsensitiveHash = 0;
 } HCIS;
+
+// Defined in the header so that hashes of string literals can be computed at compile time. Only ASCII letters are lowercased, which matches std::tolower in the "C" locale
+constexpr unsigned int HashedCaseInsensitiveString::GetHashForText(std::string_view text)
+{
+	unsigned int hash = 0;
+
+	for (size_t characterIndex = 0; characterIndex < text.size(); characterIndex++)
+	{
+		char character = text[characterIndex];
+		char lowerCaseCharacter = (character >= 'A' && character <= 'Z') ? (char)(character - 'A' + 'a') : character;
+		hash *= 31;
+		hash += (unsigned int)lowerCaseCharacter;
+	}
+
+	return hash;
+}
+
+constexpr unsigned int HashedCaseInsensitiveString::GetHashForText(char const* text)
+{
+	return GetHashForText(std::string_view(text));
+}
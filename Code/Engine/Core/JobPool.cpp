@@ -0,0 +1,73 @@
+#include "Engine/Core/JobPool.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+JobPool::~JobPool()
+{
+	GUARANTEE_RECOVERABLE(m_numAllocatedBlocks == 0, "JobPool destroyed while jobs allocated from it were not released");
+
+	for (int slabIndex = 0; slabIndex < (int)m_slabs.size(); slabIndex++)
+	{
+		delete[] m_slabs[slabIndex];
+	}
+	m_slabs.clear();
+}
+
+JobPool::JobPool(size_t blockSize, int numBlocksPerSlab)
+	: m_blockSize(blockSize)
+	, m_numBlocksPerSlab(numBlocksPerSlab)
+{
+	GUARANTEE_OR_DIE(blockSize >= sizeof(FreeBlock) && blockSize % alignof(std::max_align_t) == 0, "JobPool block size must be a multiple of the maximum fundamental alignment");
+}
+
+void* JobPool::Allocate()
+{
+	m_mutex.lock();
+	if (!m_freeList)
+	{
+		AddSlab();
+	}
+
+	FreeBlock* block = m_freeList;
+	m_freeList = block->m_next;
+	m_numAllocatedBlocks++;
+	m_mutex.unlock();
+
+	return block;
+}
+
+void JobPool::Free(void* block)
+{
+	FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(block);
+
+	m_mutex.lock();
+	freeBlock->m_next = m_freeList;
+	m_freeList = freeBlock;
+	m_numAllocatedBlocks--;
+	m_mutex.unlock();
+}
+
+void JobPool::Reserve(int numBlocks)
+{
+	m_mutex.lock();
+	while ((int)m_slabs.size() * m_numBlocksPerSlab < numBlocks)
+	{
+		AddSlab();
+	}
+	m_mutex.unlock();
+}
+
+void JobPool::AddSlab()
+{
+	// new[] of unsigned char returns memory aligned for any fundamental type, and every block size is a multiple of that alignment
+	unsigned char* slab = new unsigned char[m_blockSize * m_numBlocksPerSlab];
+	m_slabs.push_back(slab);
+
+	for (int blockIndex = m_numBlocksPerSlab - 1; blockIndex >= 0; blockIndex--)
+	{
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + m_blockSize * blockIndex);
+		block->m_next = m_freeList;
+		m_freeList = block;
+	}
+}
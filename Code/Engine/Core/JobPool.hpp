@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+
+/*! \brief A fixed-size block allocator used by the JobSystem to recycle job memory
+*
+* Blocks are carved out of slabs that are allocated from the global heap only when the free list runs out. Released blocks go back on the free list, so once the pool has grown to the peak number of jobs in flight, creating and releasing jobs no longer touches the global heap.
+* Slabs are only freed when the pool is destroyed.
+*
+*/
+class JobPool
+{
+public:
+	~JobPool();
+	JobPool(size_t blockSize, int numBlocksPerSlab);
+	JobPool(JobPool const& copyFrom) = delete;
+	void operator=(JobPool const& assignFrom) = delete;
+
+	void* Allocate();
+	void Free(void* block);
+	void Reserve(int numBlocks);
+
+	size_t GetBlockSize() const { return m_blockSize; }
+	int GetNumAllocatedBlocks() const { return m_numAllocatedBlocks; }
+	int GetNumSlabs() const { return (int)m_slabs.size(); }
+
+private:
+	void AddSlab();
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* m_next = nullptr;
+	};
+
+	size_t m_blockSize = 0;
+	int m_numBlocksPerSlab = 0;
+	std::mutex m_mutex;
+	FreeBlock* m_freeList = nullptr;
+	std::vector<unsigned char*> m_slabs;
+	int m_numAllocatedBlocks = 0;
+};
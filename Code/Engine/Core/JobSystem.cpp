@@ -1,31 +1,202 @@
 #include "JobSystem.hpp"
 
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+
+#include <algorithm>
+#include <typeinfo>
+
+
+// The worker running on the current thread, nullptr for threads that are not job workers
+static thread_local JobWorker* t_currentWorker = nullptr;
+
+// Stored in Job::m_continuations once a job has completed, its address is only compared against
+static JobContinuation s_completedJobContinuationsSentinel;
+
+static_assert(sizeof(Job) + 32 <= JobSystem::SMALLEST_JOB_POOL_BLOCK_SIZE, "Job has outgrown the smallest job pool, leaving too little room for the members of derived jobs");
+
+
+//! Deletes the continuation nodes of a job destroyed before it completed, the continuations themselves are not released
+Job::~Job()
+{
+	JobContinuation* continuation = m_continuations.load();
+	while (continuation && continuation != &s_completedJobContinuationsSentinel)
+	{
+		JobContinuation* nextContinuation = continuation->m_next;
+		delete continuation;
+		continuation = nextContinuation;
+	}
+}
 
 void Job::UpdateStatus(JobStatus newStatus)
 {
 	m_status = newStatus;
 }
 
-JobWorker::JobWorker(JobWorkerID id, JobSystem* jobSystem)
+char const* Job::GetName() const
+{
+	return typeid(*this).name();
+}
+
+bool Job::IsCancelled()
+{
+	if (m_isCancelled)
+	{
+		return true;
+	}
+
+	if (m_tag != JOBTAG_NONE && m_jobSystem && m_jobSystem->IsJobTagCancelledSince(m_tag, m_numTagCancellationsWhenQueued))
+	{
+		m_isCancelled = true;
+		return true;
+	}
+
+	return false;
+}
+
+JobWorker::JobWorker(JobWorkerID id, JobSystem* jobSystem, unsigned int workerBitFlags)
 	: m_id(id)
 	, m_jobSystem(jobSystem)
+	, m_workerBitFlags(workerBitFlags)
+	, m_nextVictimIndex((int)id + 1)
 {
-	m_thread = std::thread(&JobWorker::ThreadMain, this);
 }
 
 void JobWorker::ThreadMain()
 {
+	t_currentWorker = this;
+
+	bool collectStats = m_jobSystem->m_config.m_collectStats;
+	int numFailedClaims = 0;
+	double idleStartTime = 0.0;
+
 	while (!m_jobSystem->m_isShuttingDown)
 	{
-		Job* job = m_jobSystem->ClaimJob();
+		Job* job = m_jobSystem->ClaimJob(this);
 		if (!job)
 		{
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
+			if (collectStats && numFailedClaims == 0)
+			{
+				idleStartTime = GetCurrentTimeSeconds();
+			}
+
+			if (numFailedClaims < m_jobSystem->m_config.m_idleSpinCount)
+			{
+				numFailedClaims++;
+				std::this_thread::yield();
+				continue;
+			}
+
+			double parkStartTime = 0.0;
+			if (collectStats)
+			{
+				parkStartTime = GetCurrentTimeSeconds();
+				m_statsMutex.lock();
+				m_idleSpinSeconds += parkStartTime - idleStartTime;
+				m_statsMutex.unlock();
+			}
+
+			Park();
+
+			if (collectStats)
+			{
+				m_statsMutex.lock();
+				m_idleParkedSeconds += GetCurrentTimeSeconds() - parkStartTime;
+				m_statsMutex.unlock();
+			}
+			numFailedClaims = 0;
 			continue;
 		}
-		job->Execute();
-		m_jobSystem->MarkJobComplete(job);
+
+		if (collectStats)
+		{
+			double jobStartTime = GetCurrentTimeSeconds();
+			m_statsMutex.lock();
+			if (numFailedClaims > 0)
+			{
+				m_idleSpinSeconds += jobStartTime - idleStartTime;
+			}
+			m_statsMutex.unlock();
+			AddLatencySample(jobStartTime - job->m_queuedTime);
+		}
+		numFailedClaims = 0;
+
+		m_jobSystem->ExecuteJob(job);
+	}
+
+	t_currentWorker = nullptr;
+}
+
+void JobWorker::Park()
+{
+	std::unique_lock<std::mutex> parkLock(m_parkMutex);
+	m_wakeSignal = false;
+	m_isParked = true;
+	m_jobSystem->m_numParkedWorkers++;
+
+	// A job may have been queued between the last failed claim and setting m_isParked, in which case the queuing thread might have missed this worker
+	if (m_jobSystem->HasUnclaimedJobs(m_workerBitFlags) || m_jobSystem->m_isShuttingDown)
+	{
+		bool isStillParked = true;
+		if (m_isParked.compare_exchange_strong(isStillParked, false))
+		{
+			m_jobSystem->m_numParkedWorkers--;
+			return;
+		}
+		// Otherwise another thread has already claimed this worker and is about to signal it
+	}
+
+	m_parkCondition.wait(parkLock, [this]() { return m_wakeSignal; });
+}
+
+void JobWorker::AddLatencySample(double latencySeconds)
+{
+	m_statsMutex.lock();
+	if ((int)m_latencySamples.size() < MAX_LATENCY_SAMPLES)
+	{
+		m_latencySamples.push_back((float)latencySeconds);
+	}
+	else
+	{
+		m_latencySamples[m_nextLatencySampleIndex] = (float)latencySeconds;
+		m_nextLatencySampleIndex = (m_nextLatencySampleIndex + 1) % MAX_LATENCY_SAMPLES;
 	}
+	m_statsMutex.unlock();
+}
+
+void JobProfileTimeline::AddEvent(JobProfileEvent const& profileEvent, int maxEvents)
+{
+	m_mutex.lock();
+	if ((int)m_events.size() < maxEvents)
+	{
+		m_events.push_back(profileEvent);
+	}
+	else if (maxEvents > 0)
+	{
+		m_events[m_nextEventIndex] = profileEvent;
+		m_nextEventIndex = (m_nextEventIndex + 1) % maxEvents;
+	}
+	m_mutex.unlock();
+}
+
+void JobProfileTimeline::GetEventsInOrder(std::vector<JobProfileEvent>& out_events)
+{
+	m_mutex.lock();
+	// Once the buffer has wrapped around, the oldest event is the one that will be overwritten next
+	out_events.insert(out_events.end(), m_events.begin() + m_nextEventIndex, m_events.end());
+	out_events.insert(out_events.end(), m_events.begin(), m_events.begin() + m_nextEventIndex);
+	m_mutex.unlock();
+}
+
+void JobProfileTimeline::Clear()
+{
+	m_mutex.lock();
+	m_events.clear();
+	m_nextEventIndex = 0;
+	m_mutex.unlock();
 }
 
 JobSystem::JobSystem(JobSystemConfig config)
@@ -44,11 +215,53 @@ void JobSystem::Startup()
 		numWorkers = std::thread::hardware_concurrency();
 	}
 
-	CreateWorkers(numWorkers);
+	size_t blockSize = SMALLEST_JOB_POOL_BLOCK_SIZE;
+	for (int poolIndex = 0; poolIndex < NUM_JOB_POOLS; poolIndex++)
+	{
+		m_jobPools[poolIndex] = new JobPool(blockSize, m_config.m_numPooledJobsPerSlab);
+		m_jobPools[poolIndex]->Reserve(m_config.m_numPooledJobsPerSlab);
+		blockSize *= 2;
+	}
+
+	m_completedJobs = new MPMCQueue<Job*>((size_t)m_config.m_completedJobQueueCapacity);
+
+	m_statsResetTime = GetCurrentTimeSeconds();
+	m_profileStartTime = m_statsResetTime;
+	CreateWorkers(numWorkers, JOB_CLASS_CPU_BOUND);
+	CreateWorkers(m_config.m_numDiskIOWorkers, JOB_CLASS_DISK_IO);
+	CreateWorkers(m_config.m_numNetworkWorkers, JOB_CLASS_NETWORK);
+	StartWorkers();
+
+	if (m_config.m_enableProfiling)
+	{
+		SubscribeEventCallbackFunction("DumpJobProfile", &JobSystem::Command_DumpJobProfile, *this, "Writes the recorded job timelines to a Chrome trace file, optionally takes a \"file\" and a \"clear\" argument");
+	}
 }
 
 void JobSystem::BeginFrame()
 {
+	int frameNumber = ++m_frameNumber;
+
+	bool wasAnyPriorityOverBudget = false;
+	for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+	{
+		wasAnyPriorityOverBudget |= IsPriorityOverBudget(priorityIndex);
+		m_numJobsStartedThisFrameByPriority[priorityIndex] = 0;
+	}
+
+	int numPromotedJobs = PromoteJobsPastDeadline(frameNumber);
+
+	// Workers may have parked while jobs were held back by a budget, and promoted jobs did not wake anyone when they were queued
+	if ((wasAnyPriorityOverBudget || numPromotedJobs > 0) && m_numParkedWorkers > 0)
+	{
+		for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+		{
+			if (HasUnclaimedJobs(m_workers[workerIndex]->m_workerBitFlags))
+			{
+				WakeWorker(m_workers[workerIndex]);
+			}
+		}
+	}
 }
 
 void JobSystem::EndFrame()
@@ -57,42 +270,102 @@ void JobSystem::EndFrame()
 
 void JobSystem::Shutdown()
 {
+	if (m_config.m_enableProfiling)
+	{
+		UnsubscribeEventCallbackFunction("DumpJobProfile", &JobSystem::Command_DumpJobProfile, *this);
+	}
+
 	m_isShuttingDown = true;
 	DestroyWorkers();
 
-	m_queuedJobsMutex.lock();
-	for (int jobIndex = 0; jobIndex < (int)m_queuedJobs.size(); jobIndex++)
+	// Jobs still waiting on dependencies are only referenced by their predecessors' continuations
+	std::vector<Job*> jobsToDelete;
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
 	{
-		delete m_queuedJobs[jobIndex];
+		JobQueue& queue = m_queuedJobsByClass[jobClassIndex];
+		queue.m_mutex.lock();
+		for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+		{
+			jobsToDelete.insert(jobsToDelete.end(), queue.m_jobsByPriority[priorityIndex].begin(), queue.m_jobsByPriority[priorityIndex].end());
+			queue.m_jobsByPriority[priorityIndex].clear();
+			queue.m_numJobsInQueueByPriority[priorityIndex] = 0;
+			queue.m_numUnclaimedJobsByPriority[priorityIndex] = 0;
+		}
+		queue.m_numDeadlineJobs = 0;
+		queue.m_mutex.unlock();
 	}
-	m_queuedJobs.clear();
-	m_queuedJobsMutex.unlock();
-	
-	m_claimedJobsMutex.lock();
-	for (int jobIndex = 0; jobIndex < (int)m_claimedJobs.size(); jobIndex++)
+	for (int jobIndex = 0; jobIndex < (int)jobsToDelete.size(); jobIndex++)
 	{
-		delete m_claimedJobs[jobIndex];
+		Job* job = jobsToDelete[jobIndex];
+		JobContinuation* continuation = job->m_continuations.exchange(&s_completedJobContinuationsSentinel);
+		while (continuation && continuation != &s_completedJobContinuationsSentinel)
+		{
+			if (std::find(jobsToDelete.begin(), jobsToDelete.end(), continuation->m_job) == jobsToDelete.end())
+			{
+				jobsToDelete.push_back(continuation->m_job);
+			}
+			JobContinuation* nextContinuation = continuation->m_next;
+			delete continuation;
+			continuation = nextContinuation;
+		}
+	}
+	for (int jobIndex = 0; jobIndex < (int)jobsToDelete.size(); jobIndex++)
+	{
+		ReleaseJob(jobsToDelete[jobIndex]);
 	}
-	m_claimedJobs.clear();
-	m_claimedJobsMutex.unlock();
 
-	m_completedJobsMutex.lock();
-	for (int jobIndex = 0; jobIndex < (int)m_completedJobs.size(); jobIndex++)
+	Job* completedJob = PopCompletedJob();
+	while (completedJob)
 	{
-		delete m_completedJobs[jobIndex];
+		ReleaseJob(completedJob);
+		completedJob = PopCompletedJob();
+	}
+	delete m_completedJobs;
+	m_completedJobs = nullptr;
+
+	m_tagCancellationsMutex.lock();
+	m_tagCancellations.clear();
+	m_tagCancellationsMutex.unlock();
+
+	m_nonWorkerProfileTimelinesMutex.lock();
+	for (auto timelineIter = m_nonWorkerProfileTimelinesByThread.begin(); timelineIter != m_nonWorkerProfileTimelinesByThread.end(); ++timelineIter)
+	{
+		delete timelineIter->second;
+	}
+	m_nonWorkerProfileTimelinesByThread.clear();
+	m_nonWorkerProfileTimelinesMutex.unlock();
+
+	// Jobs retrieved with GetCompletedJob must have been released by now
+	for (int poolIndex = 0; poolIndex < NUM_JOB_POOLS; poolIndex++)
+	{
+		delete m_jobPools[poolIndex];
+		m_jobPools[poolIndex] = nullptr;
 	}
-	m_completedJobs.clear();
-	m_completedJobsMutex.unlock();
 }
 
-void JobSystem::CreateWorkers(int numWorkers)
+void JobSystem::CreateWorkers(int numWorkers, unsigned int workerBitFlags)
 {
-	m_workers.resize(numWorkers);
+	for (int workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+	{
+		JobWorker* worker = new JobWorker((JobWorkerID)m_workers.size(), this, workerBitFlags);
+		m_workers.push_back(worker);
+	}
 
-	for (int workerId = 0; workerId < numWorkers; workerId++)
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
 	{
-		JobWorker* worker = new JobWorker(workerId, this);
-		m_workers[workerId] = worker;
+		if (workerBitFlags & (1u << jobClassIndex))
+		{
+			m_queuedJobsByClass[jobClassIndex].m_numWorkers += numWorkers;
+		}
+	}
+}
+
+void JobSystem::StartWorkers()
+{
+	// Threads are only started once every worker exists, since workers read m_workers when looking for jobs to steal
+	for (int workerId = 0; workerId < (int)m_workers.size(); workerId++)
+	{
+		m_workers[workerId]->m_thread = std::thread(&JobWorker::ThreadMain, m_workers[workerId]);
 	}
 }
 
@@ -100,77 +373,945 @@ void JobSystem::DestroyWorkers()
 {
 	for (int workerId = 0; workerId < (int)m_workers.size(); workerId++)
 	{
+		WakeWorker(m_workers[workerId]);
 		m_workers[workerId]->m_thread.join();
+	}
+
+	// All worker threads have exited, so jobs left in their local deques can be safely moved back to the global queues
+	for (int workerId = 0; workerId < (int)m_workers.size(); workerId++)
+	{
+		for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+		{
+			Job* job = m_workers[workerId]->m_localJobs[priorityIndex].Steal();
+			while (job)
+			{
+				JobQueue& queue = m_queuedJobsByClass[GetJobClassIndex(job->m_jobBitFlags)];
+				queue.m_mutex.lock();
+				queue.m_jobsByPriority[priorityIndex].push_back(job);
+				queue.m_numJobsInQueueByPriority[priorityIndex]++;
+				queue.m_mutex.unlock();
+				job = m_workers[workerId]->m_localJobs[priorityIndex].Steal();
+			}
+		}
+
 		delete m_workers[workerId];
 		m_workers[workerId] = nullptr;
 	}
 
 	m_workers.clear();
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
+	{
+		m_queuedJobsByClass[jobClassIndex].m_numWorkers = 0;
+	}
+}
+
+void JobSystem::ReleaseJob(Job* job)
+{
+	if (!job)
+	{
+		return;
+	}
+
+	JobPool* pool = job->m_pool;
+	if (!pool)
+	{
+		delete job;
+		return;
+	}
+
+	// The pool block starts at the most derived object, which is not where the Job base is when Job is not the first base class
+	void* jobMemory = dynamic_cast<void*>(job);
+	job->~Job();
+	pool->Free(jobMemory);
 }
 
 void JobSystem::QueueJob(Job* job)
 {
-	m_queuedJobsMutex.lock();
-	m_queuedJobs.push_back(job);
-	m_queuedJobsMutex.unlock();
+	PrepareJobForQueue(job);
+	ScheduleJob(job);
 }
 
-Job* JobSystem::ClaimJob()
+/*! \brief Queues a job with the given priority and an optional deadline
+* \param job The job to queue
+* \param priority The priority the job is claimed with
+* \param deadlineInFrames If the job has not started after this many calls to BeginFrame it is promoted to HIGH priority, where it counts towards the HIGH per-frame budget like any other HIGH job. -1 for no deadline, values below 1 are treated as 1
+*
+*/
+void JobSystem::QueueJob(Job* job, JobPriority priority, int deadlineInFrames)
 {
-	m_queuedJobsMutex.lock();
-	if (m_queuedJobs.empty())
+	job->m_priority = priority;
+	job->m_deadlineFrame = -1;
+	if (deadlineInFrames >= 0)
 	{
-		m_queuedJobsMutex.unlock();
-		return nullptr;
+		job->m_deadlineFrame = m_frameNumber + (deadlineInFrames < 1 ? 1 : deadlineInFrames);
+	}
+
+	QueueJob(job);
+}
+
+void JobSystem::QueueJob(Job* job, std::vector<Job*> const& dependencies)
+{
+	PrepareJobForQueue(job);
+
+	// The extra pending dependency keeps a predecessor that completes during registration from scheduling this job early
+	job->m_numPendingDependencies = 1;
+	job->UpdateStatus(JobStatus::WAITING);
+
+	for (int dependencyIndex = 0; dependencyIndex < (int)dependencies.size(); dependencyIndex++)
+	{
+		Job* dependency = dependencies[dependencyIndex];
+		JobContinuation* continuation = new JobContinuation();
+		continuation->m_job = job;
+
+		// Counted before the continuation is visible, since the dependency may complete and decrement the count right after
+		job->m_numPendingDependencies++;
+		JobContinuation* firstContinuation = dependency->m_continuations.load();
+		while (true)
+		{
+			if (firstContinuation == &s_completedJobContinuationsSentinel)
+			{
+				job->m_numPendingDependencies--;
+				delete continuation;
+				break;
+			}
+			continuation->m_next = firstContinuation;
+			if (dependency->m_continuations.compare_exchange_weak(firstContinuation, continuation))
+			{
+				break;
+			}
+		}
+	}
+
+	if (--job->m_numPendingDependencies == 0)
+	{
+		ScheduleJob(job);
+	}
+}
+
+void JobSystem::PrepareJobForQueue(Job* job)
+{
+	job->m_jobSystem = this;
+	job->m_numTagCancellationsWhenQueued = m_numTagCancellations;
+}
+
+void JobSystem::ScheduleJob(Job* job)
+{
+	job->UpdateStatus(JobStatus::QUEUED);
+
+	int priorityIndex = (int)job->m_priority;
+	if (m_config.m_collectStats)
+	{
+		job->m_queuedTime = GetCurrentTimeSeconds();
+		m_numJobsQueuedByPriority[priorityIndex]++;
+	}
+
+	int jobClassIndex = GetJobClassIndex(job->m_jobBitFlags);
+	unsigned int jobClassBit = 1u << jobClassIndex;
+	JobQueue& queue = m_queuedJobsByClass[jobClassIndex];
+	GUARANTEE_OR_DIE(m_workers.empty() || queue.m_numWorkers > 0, "No job workers were created for the job's class, check JobSystemConfig");
+
+	if (job->m_priority == JobPriority::HIGH)
+	{
+		job->m_deadlineFrame = -1;
+	}
+	bool hasDeadline = job->m_deadlineFrame >= 0;
+
+	JobWorker* currentWorker = GetCurrentThreadWorker();
+	if (currentWorker && (currentWorker->m_workerBitFlags & jobClassBit) && !hasDeadline)
+	{
+		currentWorker->m_localJobs[priorityIndex].Push(job);
+	}
+	else
+	{
+		queue.m_mutex.lock();
+		queue.m_jobsByPriority[priorityIndex].push_back(job);
+		queue.m_numJobsInQueueByPriority[priorityIndex]++;
+		if (hasDeadline)
+		{
+			queue.m_numDeadlineJobs++;
+		}
+		queue.m_mutex.unlock();
+	}
+
+	queue.m_numUnclaimedJobsByPriority[priorityIndex]++;
+	if (m_numParkedWorkers > 0)
+	{
+		WakeOneParkedWorker(jobClassBit);
+	}
+}
+
+void JobSystem::WakeOneParkedWorker(unsigned int jobClassBit)
+{
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		if ((m_workers[workerIndex]->m_workerBitFlags & jobClassBit) && WakeWorker(m_workers[workerIndex]))
+		{
+			return;
+		}
+	}
+}
+
+bool JobSystem::WakeWorker(JobWorker* worker)
+{
+	bool isParked = true;
+	if (!worker->m_isParked.compare_exchange_strong(isParked, false))
+	{
+		return false;
+	}
+	m_numParkedWorkers--;
+
+	worker->m_parkMutex.lock();
+	worker->m_wakeSignal = true;
+	worker->m_parkMutex.unlock();
+	worker->m_parkCondition.notify_one();
+
+	return true;
+}
+
+Job* JobSystem::ClaimJob(JobWorker* worker, bool ignoreBudgets)
+{
+	// Threads that are not workers (such as the main thread helping in WaitFor) only run CPU-bound jobs so they never block on I/O
+	unsigned int claimBitFlags = worker ? worker->m_workerBitFlags : JOB_CLASS_CPU_BOUND;
+	bool isStarvationClaim = worker && m_config.m_starvationClaimInterval > 0 && worker->m_numClaimsSinceStarvationClaim >= m_config.m_starvationClaimInterval;
+
+	Job* job = nullptr;
+	int priorityIndex = 0;
+	for (int priorityStep = 0; priorityStep < NUM_JOB_PRIORITIES && !job; priorityStep++)
+	{
+		priorityIndex = isStarvationClaim ? NUM_JOB_PRIORITIES - 1 - priorityStep : priorityStep;
+		int maxJobsPerFrame = m_config.m_maxJobsPerFrameByPriority[priorityIndex];
+		bool isReservingBudget = !ignoreBudgets && maxJobsPerFrame >= 0;
+
+		// A slot is reserved before claiming, otherwise several workers could pass the budget check at once and all start a job
+		if (isReservingBudget && m_numJobsStartedThisFrameByPriority[priorityIndex].fetch_add(1) >= maxJobsPerFrame)
+		{
+			m_numJobsStartedThisFrameByPriority[priorityIndex]--;
+			continue;
+		}
+
+		job = ClaimJobWithPriority(worker, claimBitFlags, priorityIndex);
+		if (!job && isReservingBudget)
+		{
+			m_numJobsStartedThisFrameByPriority[priorityIndex]--;
+		}
 	}
 
-	Job* job = m_queuedJobs.front();
-	m_queuedJobs.pop_front();
-	m_queuedJobsMutex.unlock();
+	if (!job)
+	{
+		return nullptr;
+	}
 
-	m_claimedJobsMutex.lock();
-	m_claimedJobs.push_back(job);
-	m_claimedJobsMutex.unlock();
+	m_queuedJobsByClass[GetJobClassIndex(job->m_jobBitFlags)].m_numUnclaimedJobsByPriority[priorityIndex]--;
+	// Jobs claimed while ignoring budgets did not reserve a slot but still count towards the frame's budget
+	if (ignoreBudgets && m_config.m_maxJobsPerFrameByPriority[priorityIndex] >= 0)
+	{
+		m_numJobsStartedThisFrameByPriority[priorityIndex]++;
+	}
+	if (m_config.m_collectStats)
+	{
+		m_numJobsStartedByPriority[priorityIndex]++;
+		if (isStarvationClaim && priorityIndex > 0)
+		{
+			m_numStarvationClaims++;
+		}
+	}
+	if (worker)
+	{
+		worker->m_numClaimsSinceStarvationClaim = isStarvationClaim ? 0 : worker->m_numClaimsSinceStarvationClaim + 1;
+	}
 
 	job->UpdateStatus(JobStatus::CLAIMED);
+	return job;
+}
+
+Job* JobSystem::ClaimJobWithPriority(JobWorker* worker, unsigned int claimBitFlags, int priorityIndex)
+{
+	// Checking the counters first keeps empty priorities from costing a pop and a full round of steal attempts
+	if (!HasUnclaimedJobsWithPriority(claimBitFlags, priorityIndex))
+	{
+		return nullptr;
+	}
+
+	Job* job = nullptr;
+	if (worker && !worker->m_localJobs[priorityIndex].IsEmpty())
+	{
+		job = worker->m_localJobs[priorityIndex].Pop();
+	}
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES && !job; jobClassIndex++)
+	{
+		if (claimBitFlags & (1u << jobClassIndex))
+		{
+			job = ClaimJobFromGlobalQueue(worker, jobClassIndex, priorityIndex);
+		}
+	}
+	if (!job)
+	{
+		job = StealJob(worker, claimBitFlags, priorityIndex);
+	}
+
+	return job;
+}
+
+Job* JobSystem::ClaimJobFromGlobalQueue(JobWorker* worker, int jobClassIndex, int priorityIndex)
+{
+	JobQueue& queue = m_queuedJobsByClass[jobClassIndex];
+	if (queue.m_numJobsInQueueByPriority[priorityIndex].load(std::memory_order_relaxed) <= 0)
+	{
+		return nullptr;
+	}
+
+	std::deque<Job*>& jobs = queue.m_jobsByPriority[priorityIndex];
+	queue.m_mutex.lock();
+	if (jobs.empty())
+	{
+		queue.m_mutex.unlock();
+		return nullptr;
+	}
+
+	Job* job = jobs.front();
+	jobs.pop_front();
+	queue.m_numJobsInQueueByPriority[priorityIndex]--;
+	if (job->m_deadlineFrame >= 0)
+	{
+		queue.m_numDeadlineJobs--;
+	}
+
+	// Move a fair share of the remaining jobs to this worker's deque so that the global lock is taken once per batch instead of once per job
+	if (worker && queue.m_numWorkers > 0)
+	{
+		int numJobsToTransfer = (int)jobs.size() / queue.m_numWorkers;
+		if (numJobsToTransfer > MAX_JOBS_TO_TRANSFER_FROM_GLOBAL_QUEUE)
+		{
+			numJobsToTransfer = MAX_JOBS_TO_TRANSFER_FROM_GLOBAL_QUEUE;
+		}
+		// Jobs with a deadline have to stay in the global queue where BeginFrame can promote them
+		for (int jobIndex = 0; jobIndex < numJobsToTransfer; jobIndex++)
+		{
+			if (jobs[jobIndex]->m_deadlineFrame >= 0)
+			{
+				numJobsToTransfer = jobIndex;
+				break;
+			}
+		}
+		for (int jobIndex = 0; jobIndex < numJobsToTransfer; jobIndex++)
+		{
+			// Pushed from the back of the batch so that the oldest job ends up on top of the LIFO end
+			worker->m_localJobs[priorityIndex].Push(jobs[numJobsToTransfer - 1 - jobIndex]);
+		}
+		jobs.erase(jobs.begin(), jobs.begin() + numJobsToTransfer);
+		queue.m_numJobsInQueueByPriority[priorityIndex] -= numJobsToTransfer;
+	}
+	queue.m_mutex.unlock();
 
 	return job;
 }
 
+Job* JobSystem::StealJob(JobWorker* thief, unsigned int thiefBitFlags, int priorityIndex)
+{
+	int numWorkers = (int)m_workers.size();
+	int startIndex = thief ? thief->m_nextVictimIndex : 0;
+
+	for (int attempt = 0; attempt < numWorkers; attempt++)
+	{
+		int victimIndex = (startIndex + attempt) % numWorkers;
+		JobWorker* victim = m_workers[victimIndex];
+		// Every job in a victim's deque matches one of the victim's classes, so the thief must serve all of them
+		if (victim == thief || victim == nullptr || (victim->m_workerBitFlags & ~thiefBitFlags) != 0)
+		{
+			continue;
+		}
+
+		Job* job = victim->m_localJobs[priorityIndex].Steal();
+		if (job)
+		{
+			if (thief)
+			{
+				// Keep stealing from the same victim while it has work
+				thief->m_nextVictimIndex = victimIndex;
+			}
+			return job;
+		}
+	}
+
+	if (thief && numWorkers > 0)
+	{
+		thief->m_nextVictimIndex = (startIndex + 1) % numWorkers;
+	}
+	return nullptr;
+}
+
+int JobSystem::PromoteJobsPastDeadline(int frameNumber)
+{
+	int numPromotedJobs = 0;
+
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
+	{
+		JobQueue& queue = m_queuedJobsByClass[jobClassIndex];
+		if (queue.m_numDeadlineJobs <= 0)
+		{
+			continue;
+		}
+
+		int const highPriorityIndex = (int)JobPriority::HIGH;
+		queue.m_mutex.lock();
+		for (int priorityIndex = highPriorityIndex + 1; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+		{
+			std::deque<Job*>& jobs = queue.m_jobsByPriority[priorityIndex];
+			for (auto jobIter = jobs.begin(); jobIter != jobs.end();)
+			{
+				Job* job = *jobIter;
+				if (job->m_deadlineFrame < 0 || job->m_deadlineFrame > frameNumber)
+				{
+					++jobIter;
+					continue;
+				}
+
+				jobIter = jobs.erase(jobIter);
+				job->m_priority = JobPriority::HIGH;
+				job->m_deadlineFrame = -1;
+				queue.m_jobsByPriority[highPriorityIndex].push_back(job);
+
+				queue.m_numDeadlineJobs--;
+				queue.m_numJobsInQueueByPriority[priorityIndex]--;
+				queue.m_numJobsInQueueByPriority[highPriorityIndex]++;
+				// Incremented before decremented so that parking workers never see this job as missing
+				queue.m_numUnclaimedJobsByPriority[highPriorityIndex]++;
+				queue.m_numUnclaimedJobsByPriority[priorityIndex]--;
+				numPromotedJobs++;
+			}
+		}
+		queue.m_mutex.unlock();
+	}
+
+	if (m_config.m_collectStats)
+	{
+		m_numJobsPromotedByDeadline += numPromotedJobs;
+	}
+	return numPromotedJobs;
+}
+
+void JobSystem::ExecuteJob(Job* job)
+{
+	JobProfileEvent profileEvent;
+	if (m_config.m_enableProfiling)
+	{
+		profileEvent.m_jobNameID = StringPool::GetInstance().Intern(job->GetName());
+		for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
+		{
+			for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+			{
+				profileEvent.m_numUnclaimedJobsByPriority[priorityIndex] += m_queuedJobsByClass[jobClassIndex].m_numUnclaimedJobsByPriority[priorityIndex];
+			}
+		}
+		profileEvent.m_startSeconds = GetCurrentTimeSeconds();
+	}
+
+	// Cancelled jobs are dropped without running but still go through completion so that they are retrieved or released like any other job
+	if (job->IsCancelled())
+	{
+		if (m_config.m_collectStats)
+		{
+			m_numJobsCancelled++;
+		}
+	}
+	else
+	{
+		job->Execute();
+	}
+
+	// Recorded before completion since the job may be released as soon as it is marked complete
+	if (m_config.m_enableProfiling)
+	{
+		profileEvent.m_endSeconds = GetCurrentTimeSeconds();
+		profileEvent.m_wasCancelled = job->IsCancelled();
+		JobWorker* currentWorker = GetCurrentThreadWorker();
+		JobProfileTimeline* timeline = currentWorker ? &currentWorker->m_profileTimeline : GetNonWorkerProfileTimeline();
+		timeline->AddEvent(profileEvent, m_config.m_maxProfileEventsPerThread);
+	}
+
+	MarkJobComplete(job);
+}
+
 void JobSystem::MarkJobComplete(Job* job)
 {
-	m_claimedJobsMutex.lock();
-	for (auto jobIter = m_claimedJobs.begin(); jobIter != m_claimedJobs.end(); ++jobIter)
+	// Reversed so that continuations are scheduled in the order they were added
+	JobContinuation* continuations = nullptr;
+	JobContinuation* continuation = job->m_continuations.exchange(&s_completedJobContinuationsSentinel);
+	while (continuation)
+	{
+		JobContinuation* nextContinuation = continuation->m_next;
+		continuation->m_next = continuations;
+		continuations = continuation;
+		continuation = nextContinuation;
+	}
+
+	bool wasCancelled = job->IsCancelled();
+	job->UpdateStatus(wasCancelled ? JobStatus::CANCELLED : JobStatus::COMPLETED);
+
+	if (job->m_isRetrievable)
+	{
+		PushCompletedJob(job);
+	}
+	else
+	{
+		ReleaseJob(job);
+	}
+
+	// The job may be retrieved or released by now, so only the detached list of its continuations is used from here on
+	while (continuations)
+	{
+		Job* continuationJob = continuations->m_job;
+		JobContinuation* nextContinuation = continuations->m_next;
+		delete continuations;
+		continuations = nextContinuation;
+
+		// Continuations cannot run without the results of a cancelled job
+		if (wasCancelled)
+		{
+			continuationJob->m_isCancelled = true;
+		}
+		if (--continuationJob->m_numPendingDependencies == 0)
+		{
+			ScheduleJob(continuationJob);
+		}
+	}
+}
+
+Job* JobSystem::GetCompletedJob()
+{
+	Job* completedJob = PopCompletedJob();
+	if (completedJob)
+	{
+		completedJob->UpdateStatus(JobStatus::RETREIVED);
+	}
+
+	return completedJob;
+}
+
+/*! \brief Retrieves up to maxJobs completed jobs in a single call
+*
+* Does not take a lock unless more jobs completed than the completed jobs queue can hold. Jobs are appended to out_jobs roughly in the order they completed, jobs that overflowed the queue may come after jobs that completed later.
+* \param out_jobs The vector the retrieved jobs are appended to
+* \param maxJobs The maximum number of jobs to retrieve
+* \return The number of jobs retrieved
+*
+*/
+int JobSystem::GetCompletedJobs(std::vector<Job*>& out_jobs, int maxJobs)
+{
+	int numRetrievedJobs = 0;
+	while (numRetrievedJobs < maxJobs)
 	{
-		if (*jobIter == job)
+		Job* completedJob = PopCompletedJob();
+		if (!completedJob)
 		{
-			m_claimedJobs.erase(jobIter);
 			break;
 		}
+
+		completedJob->UpdateStatus(JobStatus::RETREIVED);
+		out_jobs.push_back(completedJob);
+		numRetrievedJobs++;
 	}
-	m_claimedJobsMutex.unlock();
 
-	m_completedJobsMutex.lock();
-	m_completedJobs.push_back(job);
-	m_completedJobsMutex.unlock();
+	return numRetrievedJobs;
+}
 
-	job->UpdateStatus(JobStatus::COMPLETED);
+void JobSystem::PushCompletedJob(Job* job)
+{
+	if (m_completedJobs && m_completedJobs->TryPush(job))
+	{
+		return;
+	}
+
+	m_overflowCompletedJobsMutex.lock();
+	m_overflowCompletedJobs.push_back(job);
+	m_numOverflowCompletedJobs++;
+	m_overflowCompletedJobsMutex.unlock();
 }
 
-Job* JobSystem::GetCompletedJob()
+Job* JobSystem::PopCompletedJob()
 {
-	m_completedJobsMutex.lock();
-	if (m_completedJobs.empty())
+	if (!m_completedJobs)
 	{
-		m_completedJobsMutex.unlock();
 		return nullptr;
 	}
 
-	Job* completedJob = m_completedJobs.front();
-	m_completedJobs.pop_front();
-	m_completedJobsMutex.unlock();
+	Job* completedJob = nullptr;
+	if (m_completedJobs->TryPop(completedJob))
+	{
+		return completedJob;
+	}
 
-	completedJob->UpdateStatus(JobStatus::RETREIVED);
+	if (m_numOverflowCompletedJobs <= 0)
+	{
+		return nullptr;
+	}
+
+	m_overflowCompletedJobsMutex.lock();
+	if (!m_overflowCompletedJobs.empty())
+	{
+		completedJob = m_overflowCompletedJobs.front();
+		m_overflowCompletedJobs.pop_front();
+		m_numOverflowCompletedJobs--;
+	}
+	m_overflowCompletedJobsMutex.unlock();
 
 	return completedJob;
 }
+
+void JobSystem::WaitFor(Job* job)
+{
+	// Instead of blocking, the waiting thread executes other queued jobs (possibly the one being waited on) until the job completes
+	while (job->m_status < JobStatus::COMPLETED)
+	{
+		if (!ExecuteQueuedJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/*! \brief Cancels a job that has been queued but not yet retrieved or released
+*
+* A job that has not been claimed yet is dropped without running. A running job only stops early if it polls Job::IsCancelled. Either way the job completes with JobStatus::CANCELLED and must still be retrieved and released as usual.
+* Jobs that depend on a cancelled job are cancelled as well.
+*
+*/
+void JobSystem::CancelJob(Job* job)
+{
+	job->m_isCancelled = true;
+}
+
+/*! \brief Cancels every job with the given tag that was queued before this call and has not completed yet
+*
+* Jobs with the tag queued after this call are not affected. See CancelJob for what happens to cancelled jobs.
+*
+*/
+void JobSystem::CancelJobsWithTag(JobTag tag)
+{
+	if (tag == JOBTAG_NONE)
+	{
+		return;
+	}
+
+	m_tagCancellationsMutex.lock();
+	m_tagCancellations[tag] = ++m_numTagCancellations;
+	m_tagCancellationsMutex.unlock();
+}
+
+bool JobSystem::IsJobTagCancelledSince(JobTag tag, unsigned int numTagCancellationsWhenQueued)
+{
+	if (m_numTagCancellations == numTagCancellationsWhenQueued)
+	{
+		return false;
+	}
+
+	bool isCancelled = false;
+	m_tagCancellationsMutex.lock();
+	auto tagCancellationIter = m_tagCancellations.find(tag);
+	if (tagCancellationIter != m_tagCancellations.end())
+	{
+		// Compared as a difference so that the counter wrapping around does not matter
+		isCancelled = (int)(tagCancellationIter->second - numTagCancellationsWhenQueued) > 0;
+	}
+	m_tagCancellationsMutex.unlock();
+
+	return isCancelled;
+}
+
+bool JobSystem::ExecuteQueuedJob()
+{
+	// The waiting thread must be able to run the job it waits for even if its priority is over budget for this frame
+	Job* job = ClaimJob(GetCurrentThreadWorker(), true);
+	if (!job)
+	{
+		return false;
+	}
+
+	ExecuteJob(job);
+	return true;
+}
+
+JobSystemStats JobSystem::GetStats()
+{
+	JobSystemStats stats;
+
+	double totalWorkerSeconds = (GetCurrentTimeSeconds() - m_statsResetTime) * (double)m_workers.size();
+	double idleSpinSeconds = 0.0;
+	double idleParkedSeconds = 0.0;
+	std::vector<float> latencySamples;
+
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		JobWorker* worker = m_workers[workerIndex];
+		worker->m_statsMutex.lock();
+		idleSpinSeconds += worker->m_idleSpinSeconds;
+		idleParkedSeconds += worker->m_idleParkedSeconds;
+		latencySamples.insert(latencySamples.end(), worker->m_latencySamples.begin(), worker->m_latencySamples.end());
+		worker->m_statsMutex.unlock();
+	}
+
+	if (totalWorkerSeconds > 0.0)
+	{
+		stats.m_idleSpinCPUFraction = (float)(idleSpinSeconds / totalWorkerSeconds);
+		stats.m_idleParkedFraction = (float)(idleParkedSeconds / totalWorkerSeconds);
+	}
+
+	stats.m_numLatencySamples = (int)latencySamples.size();
+	if (!latencySamples.empty())
+	{
+		int p50Index = (int)(0.5f * (float)(latencySamples.size() - 1));
+		int p99Index = (int)(0.99f * (float)(latencySamples.size() - 1));
+		std::nth_element(latencySamples.begin(), latencySamples.begin() + p50Index, latencySamples.end());
+		stats.m_p50QueueLatencySeconds = latencySamples[p50Index];
+		std::nth_element(latencySamples.begin(), latencySamples.begin() + p99Index, latencySamples.end());
+		stats.m_p99QueueLatencySeconds = latencySamples[p99Index];
+	}
+
+	for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+	{
+		stats.m_numJobsQueuedByPriority[priorityIndex] = m_numJobsQueuedByPriority[priorityIndex];
+		stats.m_numJobsStartedByPriority[priorityIndex] = m_numJobsStartedByPriority[priorityIndex];
+	}
+	stats.m_numJobsPromotedByDeadline = m_numJobsPromotedByDeadline;
+	stats.m_numStarvationClaims = m_numStarvationClaims;
+	stats.m_numJobsCancelled = m_numJobsCancelled;
+
+	return stats;
+}
+
+void JobSystem::ResetStats()
+{
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		JobWorker* worker = m_workers[workerIndex];
+		worker->m_statsMutex.lock();
+		worker->m_idleSpinSeconds = 0.0;
+		worker->m_idleParkedSeconds = 0.0;
+		worker->m_latencySamples.clear();
+		worker->m_nextLatencySampleIndex = 0;
+		worker->m_statsMutex.unlock();
+	}
+	for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+	{
+		m_numJobsQueuedByPriority[priorityIndex] = 0;
+		m_numJobsStartedByPriority[priorityIndex] = 0;
+	}
+	m_numJobsPromotedByDeadline = 0;
+	m_numStarvationClaims = 0;
+	m_numJobsCancelled = 0;
+	m_statsResetTime = GetCurrentTimeSeconds();
+}
+
+static void AppendJsonEscapedString(std::string& out_json, char const* text)
+{
+	for (char const* character = text; character && *character; character++)
+	{
+		if (*character == '"' || *character == '\\')
+		{
+			out_json += '\\';
+		}
+		if ((unsigned char)*character >= 0x20)
+		{
+			out_json += *character;
+		}
+	}
+}
+
+static void AppendChromeTraceEvents(std::string& out_json, JobProfileTimeline& timeline, int threadId, char const* threadName, double profileStartTime)
+{
+	out_json += Stringf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", threadId, threadName);
+
+	std::vector<JobProfileEvent> events;
+	timeline.GetEventsInOrder(events);
+	for (int eventIndex = 0; eventIndex < (int)events.size(); eventIndex++)
+	{
+		JobProfileEvent const& profileEvent = events[eventIndex];
+		double startMicroseconds = (profileEvent.m_startSeconds - profileStartTime) * 1000000.0;
+		double durationMicroseconds = (profileEvent.m_endSeconds - profileEvent.m_startSeconds) * 1000000.0;
+
+		out_json += "{\"name\":\"";
+		AppendJsonEscapedString(out_json, StringPool::GetInstance().GetText(profileEvent.m_jobNameID));
+		out_json += Stringf("\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n", profileEvent.m_wasCancelled ? "cancelled" : "job", threadId, startMicroseconds, durationMicroseconds);
+		out_json += Stringf("{\"name\":\"Unclaimed Jobs\",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{\"High\":%d,\"Normal\":%d,\"Low\":%d}},\n", startMicroseconds,
+			profileEvent.m_numUnclaimedJobsByPriority[(int)JobPriority::HIGH], profileEvent.m_numUnclaimedJobsByPriority[(int)JobPriority::NORMAL], profileEvent.m_numUnclaimedJobsByPriority[(int)JobPriority::LOW]);
+	}
+}
+
+/*! \brief Writes the recorded job timelines to a file in the Chrome trace event format
+*
+* The file can be opened in chrome://tracing or ui.perfetto.dev. Every worker and every non-worker thread that executed jobs gets its own track showing the jobs they executed, and a counter track shows the number of unclaimed jobs per priority.
+* Only the most recent JobSystemConfig::m_maxProfileEventsPerThread job executions of each thread are kept.
+* \param filename The path of the file to write, relative to the location of the game executable
+* \return A boolean indicating whether the file was written
+*
+*/
+bool JobSystem::WriteProfileToChromeTrace(std::string const& filename)
+{
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	static char const* const s_jobClassNames[NUM_JOB_CLASSES] = { "CPU", "Disk IO", "Network" };
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		JobWorker* worker = m_workers[workerIndex];
+		std::string threadName = Stringf("Job Worker %d (%s)", workerIndex, s_jobClassNames[GetJobClassIndex(worker->m_workerBitFlags)]);
+		AppendChromeTraceEvents(json, worker->m_profileTimeline, workerIndex, threadName.c_str(), m_profileStartTime);
+	}
+	m_nonWorkerProfileTimelinesMutex.lock();
+	int nonWorkerThreadIndex = 0;
+	for (auto timelineIter = m_nonWorkerProfileTimelinesByThread.begin(); timelineIter != m_nonWorkerProfileTimelinesByThread.end(); ++timelineIter)
+	{
+		std::string threadName = Stringf("Non-Worker Thread %d", nonWorkerThreadIndex);
+		AppendChromeTraceEvents(json, *timelineIter->second, (int)m_workers.size() + nonWorkerThreadIndex, threadName.c_str(), m_profileStartTime);
+		nonWorkerThreadIndex++;
+	}
+	m_nonWorkerProfileTimelinesMutex.unlock();
+
+	// Every event is followed by a comma, and the last one has to go
+	if (json.size() >= 2 && json[json.size() - 2] == ',')
+	{
+		json.resize(json.size() - 2);
+	}
+	json += "\n]}\n";
+
+	std::vector<uint8_t> buffer(json.begin(), json.end());
+	return FileWriteBuffer(filename, buffer) == (int)buffer.size();
+}
+
+void JobSystem::ClearProfile()
+{
+	for (int workerIndex = 0; workerIndex < (int)m_workers.size(); workerIndex++)
+	{
+		m_workers[workerIndex]->m_profileTimeline.Clear();
+	}
+	m_nonWorkerProfileTimelinesMutex.lock();
+	for (auto timelineIter = m_nonWorkerProfileTimelinesByThread.begin(); timelineIter != m_nonWorkerProfileTimelinesByThread.end(); ++timelineIter)
+	{
+		timelineIter->second->Clear();
+	}
+	m_nonWorkerProfileTimelinesMutex.unlock();
+}
+
+//! Returns the profile timeline of the calling thread, which must not be a worker, creating it the first time the thread executes a job
+JobProfileTimeline* JobSystem::GetNonWorkerProfileTimeline()
+{
+	std::thread::id threadID = std::this_thread::get_id();
+
+	m_nonWorkerProfileTimelinesMutex.lock();
+	JobProfileTimeline*& timeline = m_nonWorkerProfileTimelinesByThread[threadID];
+	if (!timeline)
+	{
+		timeline = new JobProfileTimeline();
+	}
+	JobProfileTimeline* result = timeline;
+	m_nonWorkerProfileTimelinesMutex.unlock();
+
+	return result;
+}
+
+/*! Event callback for the DumpJobProfile command
+*
+* Writes the recorded job timelines to a Chrome trace file, see WriteProfileToChromeTrace. Only registered when JobSystemConfig::m_enableProfiling is set.
+* \param args An #EventArgs structure that may optionally contain a "file" value with the path to write to (JobProfile.json by default) and a boolean "clear" flag to discard the recorded timelines after writing them
+* \return A boolean indicating whether the event was consumed
+*
+*/
+bool JobSystem::Command_DumpJobProfile(EventArgs& args)
+{
+	std::string filename = args.GetValue("file", "JobProfile.json");
+	bool wasWritten = WriteProfileToChromeTrace(filename);
+
+	if (g_console)
+	{
+		if (wasWritten)
+		{
+			g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Job profile written to %s", filename.c_str()));
+		}
+		else
+		{
+			g_console->AddLine(DevConsole::ERROR, Stringf("Could not write job profile to %s", filename.c_str()));
+		}
+	}
+
+	if (args.GetValue("clear", false))
+	{
+		ClearProfile();
+	}
+	return true;
+}
+
+bool JobSystem::HasUnclaimedJobs(unsigned int workerBitFlags) const
+{
+	// Jobs held back by the per-frame budget do not count, so that workers park until BeginFrame resets the budget
+	for (int priorityIndex = 0; priorityIndex < NUM_JOB_PRIORITIES; priorityIndex++)
+	{
+		if (!IsPriorityOverBudget(priorityIndex) && HasUnclaimedJobsWithPriority(workerBitFlags, priorityIndex))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::HasUnclaimedJobsWithPriority(unsigned int workerBitFlags, int priorityIndex) const
+{
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
+	{
+		if ((workerBitFlags & (1u << jobClassIndex)) && m_queuedJobsByClass[jobClassIndex].m_numUnclaimedJobsByPriority[priorityIndex] > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::IsPriorityOverBudget(int priorityIndex) const
+{
+	int maxJobsPerFrame = m_config.m_maxJobsPerFrameByPriority[priorityIndex];
+	return maxJobsPerFrame >= 0 && m_numJobsStartedThisFrameByPriority[priorityIndex] >= maxJobsPerFrame;
+}
+
+int JobSystem::GetJobClassIndex(unsigned int jobBitFlags)
+{
+	for (int jobClassIndex = 0; jobClassIndex < NUM_JOB_CLASSES; jobClassIndex++)
+	{
+		if (jobBitFlags & (1u << jobClassIndex))
+		{
+			return jobClassIndex;
+		}
+	}
+
+	// Jobs without a known class are treated as CPU-bound
+	return 0;
+}
+
+JobPool* JobSystem::GetJobPool(size_t jobSize, size_t jobAlignment) const
+{
+	if (jobAlignment > alignof(std::max_align_t))
+	{
+		return nullptr;
+	}
+
+	size_t blockSize = SMALLEST_JOB_POOL_BLOCK_SIZE;
+	for (int poolIndex = 0; poolIndex < NUM_JOB_POOLS; poolIndex++)
+	{
+		if (jobSize <= blockSize)
+		{
+			return m_jobPools[poolIndex];
+		}
+		blockSize *= 2;
+	}
+
+	return nullptr;
+}
+
+JobWorker* JobSystem::GetCurrentThreadWorker() const
+{
+	if (t_currentWorker && t_currentWorker->m_jobSystem == this)
+	{
+		return t_currentWorker;
+	}
+
+	return nullptr;
+}
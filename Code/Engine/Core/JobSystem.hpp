@@ -1,54 +1,223 @@
 #pragma once
 
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/JobPool.hpp"
+#include "Engine/Core/MPMCQueue.hpp"
+#include "Engine/Core/StringPool.hpp"
+#include "Engine/Core/WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <map>
 #include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
 typedef unsigned int JobWorkerID;
 constexpr JobWorkerID JOBWORKERID_INVALID = 0xFFFFFFFF;
 
+// User defined value grouping jobs that can be cancelled together with JobSystem::CancelJobsWithTag
+typedef unsigned int JobTag;
+constexpr JobTag JOBTAG_NONE = 0;
+
+// Job classes used for Job::m_jobBitFlags and JobWorker::m_workerBitFlags. A job is routed to the queue of the lowest class bit it has set and only runs on workers that have that bit set
+constexpr unsigned int JOB_CLASS_CPU_BOUND = 0x1;
+constexpr unsigned int JOB_CLASS_DISK_IO = 0x2;
+constexpr unsigned int JOB_CLASS_NETWORK = 0x4;
+constexpr int NUM_JOB_CLASSES = 3;
+
+// Jobs of a higher priority (lower value) are always claimed before jobs of a lower priority, except for the periodic starvation claims described in JobSystemConfig
+enum class JobPriority
+{
+	HIGH,
+	NORMAL,
+	LOW
+};
+constexpr int NUM_JOB_PRIORITIES = 3;
+
 class JobSystem;
 
 enum class JobStatus
 {
 	CREATED,
+	WAITING,
 	QUEUED,
 	CLAIMED,
 	COMPLETED,
+	CANCELLED,
 	RETREIVED
 };
 
 struct JobSystemConfig
 {
 public:
-	int m_numWorkers = -1; // if numWorkers == -1, one thread per core will be created
+	int m_numWorkers = -1; // CPU-bound workers, if numWorkers == -1, one thread per core will be created
+	int m_numDiskIOWorkers = 1;
+	int m_numNetworkWorkers = 0;
+
+	// Number of failed claim attempts (each followed by a yield) before an idle worker parks until QueueJob wakes it. 0 parks immediately
+	int m_idleSpinCount = 64;
+	// Whether workers record idle time and enqueue-to-start latency samples, see JobSystem::GetStats
+	bool m_collectStats = false;
+	// Every m_starvationClaimInterval-th job a worker claims is looked for from the lowest priority up, so that a steady stream of higher priority jobs cannot starve lower priority ones. 0 disables starvation protection
+	int m_starvationClaimInterval = 8;
+	// Maximum number of jobs of each priority workers start per frame (between two calls to BeginFrame), -1 for no limit. Threads helping in WaitFor or ParallelFor ignore the budget
+	int m_maxJobsPerFrameByPriority[NUM_JOB_PRIORITIES] = { -1, -1, -1 };
+
+	// Whether every job execution is recorded to per-thread timelines that can be written out with the DumpJobProfile console command
+	bool m_enableProfiling = false;
+	// Number of most recent job executions kept per thread when profiling
+	int m_maxProfileEventsPerThread = 16384;
+
+	// Capacity of the lock-free completed jobs queue, must be a power of two. Jobs completing while it is full go to a locked overflow queue
+	int m_completedJobQueueCapacity = 4096;
+
+	// Number of jobs each JobPool slab holds. Every pool reserves one slab on Startup and grows a slab at a time when it runs out
+	int m_numPooledJobsPerSlab = 256;
+};
+
+struct JobSystemStats
+{
+public:
+	float m_idleSpinCPUFraction = 0.f;		// Fraction of total worker time spent spinning while idle (burning CPU)
+	float m_idleParkedFraction = 0.f;		// Fraction of total worker time spent parked while idle (not burning CPU)
+	double m_p50QueueLatencySeconds = 0.0;	// Enqueue-to-start latency percentiles over the collected samples
+	double m_p99QueueLatencySeconds = 0.0;
+	int m_numLatencySamples = 0;
 
+	int m_numJobsQueuedByPriority[NUM_JOB_PRIORITIES] = {};
+	int m_numJobsStartedByPriority[NUM_JOB_PRIORITIES] = {};
+	int m_numJobsPromotedByDeadline = 0;	// Jobs moved to HIGH priority by BeginFrame because their deadline frame arrived before they started
+	int m_numStarvationClaims = 0;			// Claims that picked a lower priority job while looking from the lowest priority up
+	int m_numJobsCancelled = 0;				// Jobs dropped without running because they were cancelled before being claimed
+};
+
+class Job;
+
+// Node of the list of jobs waiting on a predecessor, allocated by QueueJob with dependencies and deleted when the predecessor completes
+struct JobContinuation
+{
+public:
+	Job* m_job = nullptr;
+	JobContinuation* m_next = nullptr;
 };
 
 class Job
 {
 public:
-	virtual ~Job() = default;
+	virtual ~Job();
 	virtual void Execute() = 0;
+	// Name shown for the job in profiles, defaults to the job's type name. Profiles intern a copy of the text, so it only has to stay valid while the job is alive, but should come from a small set of names since interned strings are never freed
+	virtual char const* GetName() const;
 	void UpdateStatus(JobStatus newStatus);
+	// Long running jobs can poll this in Execute and return early, the job then completes with JobStatus::CANCELLED
+	bool IsCancelled();
 
 public:
 	std::atomic<JobStatus> m_status = JobStatus::CREATED;
-	std::atomic<unsigned int> m_jobBitFlags = 0x1;
+	std::atomic<unsigned int> m_jobBitFlags = JOB_CLASS_CPU_BOUND;
+	double m_queuedTime = 0.0;
+	JobPriority m_priority = JobPriority::NORMAL;
+	// Frame number at which the job is promoted to HIGH priority if it has not started yet, -1 for no deadline. Set through QueueJob
+	int m_deadlineFrame = -1;
+	// Non-retrievable jobs are released by the JobSystem once they complete instead of being handed out by GetCompletedJob, so they must not be waited on
+	bool m_isRetrievable = true;
+	// Jobs with a tag other than JOBTAG_NONE are cancelled by CancelJobsWithTag calls made after they were queued
+	JobTag m_tag = JOBTAG_NONE;
+	std::atomic<bool> m_isCancelled = false;
+	unsigned int m_numTagCancellationsWhenQueued = 0;
+	JobSystem* m_jobSystem = nullptr;
+
+	// Pool the job's memory came from when created with JobSystem::CreateJob, nullptr for jobs allocated with new
+	JobPool* m_pool = nullptr;
+
+	// Number of predecessors that have to complete before this job is queued
+	std::atomic<int> m_numPendingDependencies = 0;
+	// Lock-free list of the jobs that depend on this job, most recently added first. Replaced by a sentinel once the job completes so that no more continuations can be added
+	std::atomic<JobContinuation*> m_continuations = nullptr;
+};
+
+struct JobProfileEvent
+{
+public:
+	// Interned when the job executes, since the job and any name it owns may be gone by the time the profile is written
+	StringID m_jobNameID = STRINGID_EMPTY;
+	double m_startSeconds = 0.0;
+	double m_endSeconds = 0.0;
+	// Jobs waiting to be claimed when this job started, summed over all job classes
+	int m_numUnclaimedJobsByPriority[NUM_JOB_PRIORITIES] = {};
+	bool m_wasCancelled = false;
+};
+
+// Ring buffer of the most recent job executions on a single thread, the oldest events are overwritten once it is full
+struct JobProfileTimeline
+{
+public:
+	void AddEvent(JobProfileEvent const& profileEvent, int maxEvents);
+	void GetEventsInOrder(std::vector<JobProfileEvent>& out_events);
+	void Clear();
+
+public:
+	std::mutex m_mutex;
+	std::vector<JobProfileEvent> m_events;
+	int m_nextEventIndex = 0;
 };
 
 class JobWorker
 {
 public:
-	JobWorker(JobWorkerID id, JobSystem* jobSystem);
+	JobWorker(JobWorkerID id, JobSystem* jobSystem, unsigned int workerBitFlags = JOB_CLASS_CPU_BOUND);
 	void ThreadMain();
+	void Park();
+	void AddLatencySample(double latencySeconds);
 
 public:
 	std::atomic<JobWorkerID> m_id = JOBWORKERID_INVALID;
 	JobSystem* m_jobSystem = nullptr;
 	std::thread m_thread;
-	unsigned int m_workerBitFlags = 0x1;
+	unsigned int m_workerBitFlags = JOB_CLASS_CPU_BOUND;
+
+	// Jobs queued from this worker's thread that match m_workerBitFlags are pushed here by priority, idle workers of the same classes steal from the other end
+	WorkStealingDeque<Job*> m_localJobs[NUM_JOB_PRIORITIES];
+	int m_nextVictimIndex = 0;
+	int m_numClaimsSinceStarvationClaim = 0;
+
+	// Parking state, a parked worker sleeps on m_parkCondition until another thread claims m_isParked and sets m_wakeSignal
+	std::atomic<bool> m_isParked = false;
+	std::mutex m_parkMutex;
+	std::condition_variable m_parkCondition;
+	bool m_wakeSignal = false;
+
+	// Stats, only written when JobSystemConfig::m_collectStats is set
+	static constexpr int MAX_LATENCY_SAMPLES = 1024;
+	std::mutex m_statsMutex;
+	double m_idleSpinSeconds = 0.0;
+	double m_idleParkedSeconds = 0.0;
+	std::vector<float> m_latencySamples;
+	int m_nextLatencySampleIndex = 0;
+
+	// Only written when JobSystemConfig::m_enableProfiling is set
+	JobProfileTimeline m_profileTimeline;
+};
+
+// Jobs of a single class queued from threads that cannot push to their own deque (usually the main thread), and jobs with a deadline
+struct JobQueue
+{
+public:
+	std::mutex m_mutex;
+	std::deque<Job*> m_jobsByPriority[NUM_JOB_PRIORITIES];
+	std::atomic<int> m_numJobsInQueueByPriority[NUM_JOB_PRIORITIES] = {};
+	// Jobs of this class queued anywhere (this queue or worker deques) that have not been claimed yet, checked by workers before parking
+	std::atomic<int> m_numUnclaimedJobsByPriority[NUM_JOB_PRIORITIES] = {};
+	// Jobs in this queue waiting for their deadline frame, deadline jobs are never moved to worker deques so that BeginFrame can promote them
+	std::atomic<int> m_numDeadlineJobs = 0;
+	int m_numWorkers = 0;
 };
 
 class JobSystem
@@ -63,27 +232,120 @@ public:
 	void EndFrame();
 	void Shutdown();
 
-	void CreateWorkers(int numWorkers);
+	void CreateWorkers(int numWorkers, unsigned int workerBitFlags = JOB_CLASS_CPU_BOUND);
+	void StartWorkers();
 	void DestroyWorkers();
 
+	template<typename T, typename... Args>
+	T* CreateJob(Args&&... args);
+	void ReleaseJob(Job* job);
+
 	void QueueJob(Job* job);
-	Job* ClaimJob();
+	void QueueJob(Job* job, JobPriority priority, int deadlineInFrames = -1);
+	void QueueJob(Job* job, std::vector<Job*> const& dependencies);
+	Job* ClaimJob(JobWorker* worker = nullptr, bool ignoreBudgets = false);
+	void ExecuteJob(Job* job);
 	void MarkJobComplete(Job* job);
 	Job* GetCompletedJob();
+	int GetCompletedJobs(std::vector<Job*>& out_jobs, int maxJobs);
+	void WaitFor(Job* job);
+	bool ExecuteQueuedJob();
+
+	void CancelJob(Job* job);
+	void CancelJobsWithTag(JobTag tag);
+	bool IsJobTagCancelledSince(JobTag tag, unsigned int numTagCancellationsWhenQueued);
 
+	JobWorker* GetCurrentThreadWorker() const;
+	JobProfileTimeline* GetNonWorkerProfileTimeline();
+	bool HasUnclaimedJobs(unsigned int workerBitFlags) const;
+	bool HasUnclaimedJobsWithPriority(unsigned int workerBitFlags, int priorityIndex) const;
+	bool IsPriorityOverBudget(int priorityIndex) const;
+	int GetFrameNumber() const { return m_frameNumber; }
+	static int GetJobClassIndex(unsigned int jobBitFlags);
+
+	JobSystemStats GetStats();
+	void ResetStats();
+
+	bool WriteProfileToChromeTrace(std::string const& filename);
+	void ClearProfile();
+	bool Command_DumpJobProfile(EventArgs& args);
+
+protected:
+	void ScheduleJob(Job* job);
+	void WakeOneParkedWorker(unsigned int jobClassBit);
+	bool WakeWorker(JobWorker* worker);
+
+	Job* ClaimJobWithPriority(JobWorker* worker, unsigned int claimBitFlags, int priorityIndex);
+	Job* ClaimJobFromGlobalQueue(JobWorker* worker, int jobClassIndex, int priorityIndex);
+	Job* StealJob(JobWorker* thief, unsigned int thiefBitFlags, int priorityIndex);
+	int PromoteJobsPastDeadline(int frameNumber);
+	void PrepareJobForQueue(Job* job);
+	void PushCompletedJob(Job* job);
+	Job* PopCompletedJob();
+
+	JobPool* GetJobPool(size_t jobSize, size_t jobAlignment) const;
 
 public:
+	static constexpr int MAX_JOBS_TO_TRANSFER_FROM_GLOBAL_QUEUE = 16;
+	// Pools hold blocks of 128, 256, 512 and 1024 bytes, larger jobs fall back to the global heap
+	static constexpr int NUM_JOB_POOLS = 4;
+	static constexpr size_t SMALLEST_JOB_POOL_BLOCK_SIZE = 128;
+
 	JobSystemConfig m_config;
 	std::vector<JobWorker*> m_workers;
 	std::atomic<bool> m_isShuttingDown = false;
 
-	std::mutex m_queuedJobsMutex;
-	std::deque<Job*> m_queuedJobs;
+	JobQueue m_queuedJobsByClass[NUM_JOB_CLASSES];
+	std::atomic<int> m_numParkedWorkers = 0;
+	double m_statsResetTime = 0.0;
+
+	std::atomic<int> m_frameNumber = 0;
+	std::atomic<int> m_numJobsStartedThisFrameByPriority[NUM_JOB_PRIORITIES] = {};
 
-	std::mutex m_claimedJobsMutex;
-	std::deque<Job*> m_claimedJobs;
+	// Per priority counters, only updated when JobSystemConfig::m_collectStats is set
+	std::atomic<int> m_numJobsQueuedByPriority[NUM_JOB_PRIORITIES] = {};
+	std::atomic<int> m_numJobsStartedByPriority[NUM_JOB_PRIORITIES] = {};
+	std::atomic<int> m_numJobsPromotedByDeadline = 0;
+	std::atomic<int> m_numStarvationClaims = 0;
+	std::atomic<int> m_numJobsCancelled = 0;
 
-	std::mutex m_completedJobsMutex;
-	std::deque<Job*> m_completedJobs;
+	// Incremented by every CancelJobsWithTag call. Jobs queued after the latest call cannot have been cancelled by tag, so the common case needs no lock
+	std::atomic<unsigned int> m_numTagCancellations = 0;
+	std::mutex m_tagCancellationsMutex;
+	// Value of m_numTagCancellations right after each tag was last cancelled
+	std::map<JobTag, unsigned int> m_tagCancellations;
+
+	MPMCQueue<Job*>* m_completedJobs = nullptr;
+	// Only used when m_completedJobs is full
+	std::mutex m_overflowCompletedJobsMutex;
+	std::deque<Job*> m_overflowCompletedJobs;
+	std::atomic<int> m_numOverflowCompletedJobs = 0;
+
+	JobPool* m_jobPools[NUM_JOB_POOLS] = {};
+
+	// Timelines for jobs executed by threads that are not workers, such as the main thread helping in WaitFor, one per thread so that jobs running on different threads at once do not appear nested
+	std::mutex m_nonWorkerProfileTimelinesMutex;
+	std::map<std::thread::id, JobProfileTimeline*> m_nonWorkerProfileTimelinesByThread;
+	double m_profileStartTime = 0.0;
 };
 
+/*! \brief Constructs a job of type T in memory recycled from the JobSystem's job pools
+*
+* Once the pools have grown to the peak number of jobs in flight, creating a job does not touch the global heap. Jobs too large for the biggest pool, or created before Startup, are allocated from the global heap instead.
+* Jobs created this way must be released with ReleaseJob after they have been retrieved with GetCompletedJob, never deleted. Non-retrievable jobs are released by the JobSystem once they complete.
+* \param args Arguments forwarded to the constructor of T
+* \return The newly constructed job
+*
+*/
+template<typename T, typename... Args>
+T* JobSystem::CreateJob(Args&&... args)
+{
+	static_assert(std::is_base_of<Job, T>::value, "JobSystem::CreateJob can only create types derived from Job");
+
+	// Jobs that do not fit a pool use a regular new expression, which respects over-aligned types and matches the delete in ReleaseJob
+	JobPool* pool = GetJobPool(sizeof(T), alignof(T));
+	T* job = pool ? new (pool->Allocate()) T(std::forward<Args>(args)...) : new T(std::forward<Args>(args)...);
+	job->m_pool = pool;
+	return job;
+}
+
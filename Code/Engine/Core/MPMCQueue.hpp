@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+
+/*! \brief A bounded lock-free multi-producer multi-consumer queue
+*
+* Every slot of the ring buffer carries a sequence number that tells producers and consumers whether the slot is free to write or ready to read, so pushing and popping only take a compare-and-swap on the shared position (Dmitry Vyukov's bounded MPMC queue).
+* TryPush fails instead of blocking when the queue is full and TryPop fails when it is empty. Items are popped in the order their pushes claimed a slot.
+* The capacity must be a power of two.
+*
+*/
+template<typename T>
+class MPMCQueue
+{
+	struct Cell
+	{
+	public:
+		std::atomic<size_t> m_sequence = 0;
+		T m_item = T();
+	};
+
+public:
+	~MPMCQueue()
+	{
+		delete[] m_cells;
+	}
+
+	explicit MPMCQueue(size_t capacity)
+		: m_cells(new Cell[capacity])
+		, m_mask(capacity - 1)
+	{
+		GUARANTEE_OR_DIE(capacity >= 2 && (capacity & (capacity - 1)) == 0, "MPMCQueue capacity must be a power of two");
+		for (size_t cellIndex = 0; cellIndex < capacity; cellIndex++)
+		{
+			m_cells[cellIndex].m_sequence.store(cellIndex, std::memory_order_relaxed);
+		}
+	}
+
+	MPMCQueue(MPMCQueue const& copyFrom) = delete;
+	void operator=(MPMCQueue const& assignFrom) = delete;
+
+	bool TryPush(T const& item)
+	{
+		Cell* cell = nullptr;
+		size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[position & m_mask];
+			size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+			ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+			if (difference == 0)
+			{
+				// The slot is free, try to claim it
+				if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The slot still holds an item from the previous lap, so the queue is full
+				return false;
+			}
+			else
+			{
+				// Another producer claimed the slot first
+				position = m_enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->m_item = item;
+		cell->m_sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPop(T& out_item)
+	{
+		Cell* cell = nullptr;
+		size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[position & m_mask];
+			size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+			ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)(position + 1);
+			if (difference == 0)
+			{
+				// The slot has been written, try to claim it
+				if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The slot has not been written yet, so the queue is empty
+				return false;
+			}
+			else
+			{
+				// Another consumer claimed the slot first
+				position = m_dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		out_item = cell->m_item;
+		// Frees the slot for the producer one lap ahead
+		cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t GetCapacity() const { return m_mask + 1; }
+
+private:
+	Cell* m_cells = nullptr;
+	size_t m_mask = 0;
+	alignas(64) std::atomic<size_t> m_enqueuePosition = 0;
+	alignas(64) std::atomic<size_t> m_dequeuePosition = 0;
+};
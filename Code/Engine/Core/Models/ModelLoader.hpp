@@ -3,6 +3,8 @@
 #include "Engine/Core/Models/Material.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 
+#include <map>
+
 struct Model;
 class Texture;
 
@@ -1,5 +1,120 @@
 #include "Engine/Core/NamedProperties.hpp"
 
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+//! \cond
+// Hides the binary format details from doxygen documentation
+// Tags identifying the type of each value written by NamedProperties::AppendToBuffer. New types must be added at the end so that existing cache files keep their meaning
+enum class NamedPropertyBinaryType : unsigned char
+{
+	BOOL,
+	CHAR,
+	INT,
+	UNSIGNED_INT,
+	FLOAT,
+	DOUBLE,
+	STRING,
+	RGBA8,
+	VEC2,
+	VEC3,
+	INTVEC2,
+	UNSUPPORTED = 0xFF,
+};
+
+// Bumped whenever the layout of the cache file or of the properties in it changes, so stale cache files are ignored
+constexpr unsigned char NAMED_PROPERTIES_BINARY_CACHE_VERSION = 1;
+constexpr char NAMED_PROPERTIES_BINARY_CACHE_FOURCC[4] = { 'N', 'P', 'B', 'C' };
+
+static NamedPropertyBinaryType GetNamedPropertyBinaryType(PropertyValue const& property)
+{
+	PropertyTypeInfo const* typeInfo = property.m_typeInfo;
+	if (typeInfo == GetPropertyTypeInfo<std::string>() || typeInfo == GetPropertyTypeInfo<char const*>())
+	{
+		return NamedPropertyBinaryType::STRING;
+	}
+	if (typeInfo == GetPropertyTypeInfo<bool>())
+	{
+		return NamedPropertyBinaryType::BOOL;
+	}
+	if (typeInfo == GetPropertyTypeInfo<char>())
+	{
+		return NamedPropertyBinaryType::CHAR;
+	}
+	if (typeInfo == GetPropertyTypeInfo<int>())
+	{
+		return NamedPropertyBinaryType::INT;
+	}
+	if (typeInfo == GetPropertyTypeInfo<unsigned int>())
+	{
+		return NamedPropertyBinaryType::UNSIGNED_INT;
+	}
+	if (typeInfo == GetPropertyTypeInfo<float>())
+	{
+		return NamedPropertyBinaryType::FLOAT;
+	}
+	if (typeInfo == GetPropertyTypeInfo<double>())
+	{
+		return NamedPropertyBinaryType::DOUBLE;
+	}
+	if (typeInfo == GetPropertyTypeInfo<Rgba8>())
+	{
+		return NamedPropertyBinaryType::RGBA8;
+	}
+	if (typeInfo == GetPropertyTypeInfo<Vec2>())
+	{
+		return NamedPropertyBinaryType::VEC2;
+	}
+	if (typeInfo == GetPropertyTypeInfo<Vec3>())
+	{
+		return NamedPropertyBinaryType::VEC3;
+	}
+	if (typeInfo == GetPropertyTypeInfo<IntVec2>())
+	{
+		return NamedPropertyBinaryType::INTVEC2;
+	}
+	return NamedPropertyBinaryType::UNSUPPORTED;
+}
+
+// Number of bytes AppendToBuffer writes for a value of a type, strings take at least their 4 byte length. Returns 0 for unknown tags
+static int GetNamedPropertyBinaryValueSize(NamedPropertyBinaryType binaryType)
+{
+	switch (binaryType)
+	{
+		case NamedPropertyBinaryType::BOOL:
+		case NamedPropertyBinaryType::CHAR:
+		{
+			return 1;
+		}
+		case NamedPropertyBinaryType::INT:
+		case NamedPropertyBinaryType::UNSIGNED_INT:
+		case NamedPropertyBinaryType::FLOAT:
+		case NamedPropertyBinaryType::RGBA8:
+		case NamedPropertyBinaryType::STRING:
+		{
+			return 4;
+		}
+		case NamedPropertyBinaryType::DOUBLE:
+		case NamedPropertyBinaryType::VEC2:
+		case NamedPropertyBinaryType::INTVEC2:
+		{
+			return 8;
+		}
+		case NamedPropertyBinaryType::VEC3:
+		{
+			return 12;
+		}
+		default:
+		{
+			return 0;
+		}
+	}
+}
+//! \endcond
+
 
 /*! \brief Adds all attributes of the given XmlElement to the NamedStrings instance
 *
@@ -17,6 +132,289 @@ void NamedProperties::PopulateFromXmlElementAttributes(XmlElement const& element
 	}
 }
 
+/*! \brief Adds all attributes of the root element of an XML file, using a binary cache of the file when it is up to date
+*
+* The cache is a file next to the XML file with BINARY_CACHE_FILE_EXTENSION appended to its name. It stores the last write time of the XML file it was built from, and is only used when that time matches the XML file, so editing the XML file invalidates it. When the cache is missing or stale the XML file is parsed and the cache is rewritten.
+* Loading the cache skips XML parsing entirely, which makes it considerably faster for large config files such as the one for g_gameConfigBlackboard.
+* \param xmlFilePath The path of the XML file, relative to the location of the game executable
+* \param useBinaryCache Whether the binary cache should be read and written
+* \return A boolean indicating whether the properties could be loaded from either the cache or the XML file
+*
+*/
+bool NamedProperties::PopulateFromXmlFile(std::string const& xmlFilePath, bool useBinaryCache)
+{
+	std::string cacheFilePath = xmlFilePath + BINARY_CACHE_FILE_EXTENSION;
+	uint64_t xmlLastWriteTime = 0;
+	bool isXmlLastWriteTimeKnown = GetFileLastWriteTime(xmlLastWriteTime, xmlFilePath);
+
+	if (useBinaryCache && isXmlLastWriteTimeKnown)
+	{
+		// The cache is parsed straight from the mapped file, which is closed again before the cache could be rewritten below
+		MemoryMappedFile cacheFile;
+		size_t const cacheHeaderSize = 4 + 1 + 8 + 4;
+		if (cacheFile.Open(cacheFilePath) && cacheFile.GetSize() >= cacheHeaderSize)
+		{
+			BufferParser cacheParser(cacheFile.GetData(), cacheFile.GetSize());
+			cacheParser.SetEndianMode(BufferEndian::LITTLE);
+
+			bool isCacheValid = true;
+			for (int fourCCIndex = 0; fourCCIndex < 4; fourCCIndex++)
+			{
+				isCacheValid &= (cacheParser.ParseChar() == (unsigned char)NAMED_PROPERTIES_BINARY_CACHE_FOURCC[fourCCIndex]);
+			}
+			isCacheValid &= (cacheParser.ParseByte() == NAMED_PROPERTIES_BINARY_CACHE_VERSION);
+			isCacheValid &= (cacheParser.ParseUint64() == xmlLastWriteTime);
+			uint32_t payloadSize = cacheParser.ParseUint32();
+			isCacheValid &= (payloadSize == (uint32_t)cacheParser.GetRemainingSize());
+
+			if (isCacheValid && PopulateFromBuffer(cacheParser))
+			{
+				return true;
+			}
+		}
+	}
+
+	XmlDocument xmlDocument;
+	XmlResult result = xmlDocument.LoadFile(xmlFilePath.c_str());
+	if (result != XmlResult::XML_SUCCESS || !xmlDocument.RootElement())
+	{
+		return false;
+	}
+
+	NamedProperties xmlProperties;
+	xmlProperties.PopulateFromXmlElementAttributes(*xmlDocument.RootElement());
+	AddProperties(xmlProperties);
+
+	if (useBinaryCache && isXmlLastWriteTimeKnown)
+	{
+		std::vector<uint8_t> cacheBuffer;
+		BufferWriter cacheWriter(cacheBuffer);
+		cacheWriter.SetEndianMode(BufferEndian::LITTLE);
+		for (int fourCCIndex = 0; fourCCIndex < 4; fourCCIndex++)
+		{
+			cacheWriter.AppendChar((unsigned char)NAMED_PROPERTIES_BINARY_CACHE_FOURCC[fourCCIndex]);
+		}
+		cacheWriter.AppendByte(NAMED_PROPERTIES_BINARY_CACHE_VERSION);
+		cacheWriter.AppendUint64(xmlLastWriteTime);
+		int payloadSizePosition = cacheWriter.GetTotalSize();
+		cacheWriter.AppendUint32(0);
+
+		// Only the properties read from the XML file are cached, properties set before this call did not come from the file
+		if (xmlProperties.AppendToBuffer(cacheWriter))
+		{
+			cacheWriter.OverwriteUint32AtPosition((uint32_t)(cacheWriter.GetTotalSize() - payloadSizePosition - 4), payloadSizePosition);
+			FileWriteBuffer(cacheFilePath, cacheBuffer);
+		}
+	}
+
+	return true;
+}
+
+/*! \brief Appends all properties to a buffer in a compact binary form that can be read back with PopulateFromBuffer
+*
+* Each property is written as its key, a one byte type tag and the value. Only values of the types that GetValue knows about (bool, char, int, unsigned int, float, double, strings, Rgba8, Vec2, Vec3 and IntVec2) can be written; char const* values are written as strings.
+* \param bufferWriter The BufferWriter to append the properties to, its endian mode is used for all values
+* \return A boolean indicating whether the properties were appended, false if any value has a type that cannot be written in which case nothing is appended
+*
+*/
+bool NamedProperties::AppendToBuffer(BufferWriter& bufferWriter) const
+{
+	int numProperties = GetNumProperties();
+	for (int propertyIndex = 0; propertyIndex < numProperties; propertyIndex++)
+	{
+		if (GetNamedPropertyBinaryType(GetPropertyValue(propertyIndex)) == NamedPropertyBinaryType::UNSUPPORTED)
+		{
+			return false;
+		}
+	}
+
+	bufferWriter.AppendUint32((uint32_t)numProperties);
+	for (int propertyIndex = 0; propertyIndex < numProperties; propertyIndex++)
+	{
+		PropertyValue const& property = GetPropertyValue(propertyIndex);
+		NamedPropertyBinaryType binaryType = GetNamedPropertyBinaryType(property);
+
+		bufferWriter.AppendStringAfter32BitLength(GetPropertyKey(propertyIndex).GetOriginalString());
+		bufferWriter.AppendByte((unsigned char)binaryType);
+		switch (binaryType)
+		{
+			case NamedPropertyBinaryType::BOOL:
+			{
+				bufferWriter.AppendBool(*property.GetValuePointer<bool>());
+				break;
+			}
+			case NamedPropertyBinaryType::CHAR:
+			{
+				bufferWriter.AppendChar(*property.GetValuePointer<char>());
+				break;
+			}
+			case NamedPropertyBinaryType::INT:
+			{
+				bufferWriter.AppendInt32(*property.GetValuePointer<int>());
+				break;
+			}
+			case NamedPropertyBinaryType::UNSIGNED_INT:
+			{
+				bufferWriter.AppendUint32(*property.GetValuePointer<unsigned int>());
+				break;
+			}
+			case NamedPropertyBinaryType::FLOAT:
+			{
+				bufferWriter.AppendFloat(*property.GetValuePointer<float>());
+				break;
+			}
+			case NamedPropertyBinaryType::DOUBLE:
+			{
+				bufferWriter.AppendDouble(*property.GetValuePointer<double>());
+				break;
+			}
+			case NamedPropertyBinaryType::RGBA8:
+			{
+				bufferWriter.AppendRgba(*property.GetValuePointer<Rgba8>());
+				break;
+			}
+			case NamedPropertyBinaryType::VEC2:
+			{
+				bufferWriter.AppendVec2(*property.GetValuePointer<Vec2>());
+				break;
+			}
+			case NamedPropertyBinaryType::VEC3:
+			{
+				bufferWriter.AppendVec3(*property.GetValuePointer<Vec3>());
+				break;
+			}
+			case NamedPropertyBinaryType::INTVEC2:
+			{
+				bufferWriter.AppendIntVec2(*property.GetValuePointer<IntVec2>());
+				break;
+			}
+			case NamedPropertyBinaryType::STRING:
+			{
+				std::string const* valueAsStr = property.GetValuePointer<std::string>();
+				bufferWriter.AppendStringAfter32BitLength(valueAsStr ? *valueAsStr : std::string(*property.GetValuePointer<char const*>()));
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*! \brief Adds the properties from a buffer written by AppendToBuffer
+*
+* Values are restored with the types they were written with, except that char const* values are restored as std::string since the memory they pointed to is not part of the buffer. Existing properties with the same keys are overwritten.
+* \param bufferParser The BufferParser positioned at the start of the properties, its endian mode must match the one they were written with
+* Every count and length is checked against the rest of the buffer before it is parsed, so a corrupt buffer such as a damaged cache file makes this return false rather than failing a GUARANTEE_OR_DIE.
+* \return A boolean indicating whether the properties were read, false if the buffer is truncated or contains an unknown type tag in which case no properties are added
+*
+*/
+bool NamedProperties::PopulateFromBuffer(BufferParser& bufferParser)
+{
+	if (bufferParser.GetRemainingSize() < 4)
+	{
+		return false;
+	}
+
+	// Every property takes at least a 4 byte key length, a type tag and a 1 byte value
+	uint32_t numProperties = bufferParser.ParseUint32();
+	if (numProperties > (uint32_t)bufferParser.GetRemainingSize() / 6)
+	{
+		return false;
+	}
+
+	NamedProperties parsedProperties;
+	for (uint32_t propertyIndex = 0; propertyIndex < numProperties; propertyIndex++)
+	{
+		std::string keyName;
+		if (!bufferParser.TryParseStringAfter32BitLength(keyName) || bufferParser.GetRemainingSize() < 1)
+		{
+			return false;
+		}
+
+		NamedPropertyBinaryType binaryType = (NamedPropertyBinaryType)bufferParser.ParseByte();
+		int valueSize = GetNamedPropertyBinaryValueSize(binaryType);
+		if (valueSize == 0 || bufferParser.GetRemainingSize() < valueSize)
+		{
+			return false;
+		}
+
+		switch (binaryType)
+		{
+			case NamedPropertyBinaryType::BOOL:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseBool());
+				break;
+			}
+			case NamedPropertyBinaryType::CHAR:
+			{
+				parsedProperties.SetValue(keyName, (char)bufferParser.ParseChar());
+				break;
+			}
+			case NamedPropertyBinaryType::INT:
+			{
+				parsedProperties.SetValue(keyName, (int)bufferParser.ParseInt32());
+				break;
+			}
+			case NamedPropertyBinaryType::UNSIGNED_INT:
+			{
+				parsedProperties.SetValue(keyName, (unsigned int)bufferParser.ParseUint32());
+				break;
+			}
+			case NamedPropertyBinaryType::FLOAT:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseFloat());
+				break;
+			}
+			case NamedPropertyBinaryType::DOUBLE:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseDouble());
+				break;
+			}
+			case NamedPropertyBinaryType::RGBA8:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseRgba());
+				break;
+			}
+			case NamedPropertyBinaryType::VEC2:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseVec2());
+				break;
+			}
+			case NamedPropertyBinaryType::VEC3:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseVec3());
+				break;
+			}
+			case NamedPropertyBinaryType::INTVEC2:
+			{
+				parsedProperties.SetValue(keyName, bufferParser.ParseIntVec2());
+				break;
+			}
+			case NamedPropertyBinaryType::STRING:
+			{
+				std::string value;
+				if (!bufferParser.TryParseStringAfter32BitLength(value))
+				{
+					return false;
+				}
+				parsedProperties.SetValue(keyName, value);
+				break;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	AddProperties(parsedProperties);
+	return true;
+}
+
 /*! \brief Gets the value for a given key as a boolean
 *
 * If no value corresponding to the given key is found or it does not match a boolean literal, the defaultValue is returned.
@@ -28,40 +426,40 @@ void NamedProperties::PopulateFromXmlElementAttributes(XmlElement const& element
 bool NamedProperties::GetValue(std::string const& keyName, bool defaultValue) const
 {
 	bool value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
 		
 		// The value exists, as a bool, as a string/cstr or some completely other type
-		TypedProperty<bool>* typedPropertyAsBool = dynamic_cast<TypedProperty<bool>*>(mapIter->second);
-		if (typedPropertyAsBool)
+		bool const* valueAsBool = property->GetValuePointer<bool>();
+		if (valueAsBool)
 		{
-			value = typedPropertyAsBool->m_data;
+			value = *valueAsBool;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				if (!_stricmp(typedPropertyAsStr->m_data.c_str(), "true"))
+				if (!_stricmp(valueAsStr->c_str(), "true"))
 				{
 					value = true;
 				}
-				else if (!_stricmp(typedPropertyAsStr->m_data.c_str(), "false"))
+				else if (!_stricmp(valueAsStr->c_str(), "false"))
 				{
 					value = false;
 				}
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					if (!_stricmp(typedPropertyAsCStr->m_data, "true"))
+					if (!_stricmp((*valueAsCStr), "true"))
 					{
 						value = true;
 					}
-					else if (!_stricmp(typedPropertyAsCStr->m_data, "false"))
+					else if (!_stricmp((*valueAsCStr), "false"))
 					{
 						value = false;
 					}
@@ -83,27 +481,27 @@ bool NamedProperties::GetValue(std::string const& keyName, bool defaultValue) co
 int NamedProperties::GetValue(std::string const& keyName, int defaultValue) const
 {
 	int value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<int>* typedPropertyAsInt = dynamic_cast<TypedProperty<int>*>(mapIter->second);
-		if (typedPropertyAsInt)
+		int const* valueAsInt = property->GetValuePointer<int>();
+		if (valueAsInt)
 		{
-			value = typedPropertyAsInt->m_data;
+			value = *valueAsInt;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value = atoi(typedPropertyAsStr->m_data.c_str());
+				value = atoi(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value = atoi(typedPropertyAsCStr->m_data);
+					value = atoi(*valueAsCStr);
 				}
 			}
 		}
@@ -114,27 +512,27 @@ int NamedProperties::GetValue(std::string const& keyName, int defaultValue) cons
 unsigned char NamedProperties::GetValue(std::string const& keyName, unsigned char defaultValue) const
 {
 	char value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<char>* typedPropertyAsChar = dynamic_cast<TypedProperty<char>*>(mapIter->second);
-		if (typedPropertyAsChar)
+		char const* valueAsChar = property->GetValuePointer<char>();
+		if (valueAsChar)
 		{
-			value = typedPropertyAsChar->m_data;
+			value = *valueAsChar;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value = (unsigned char)atoi(typedPropertyAsStr->m_data.c_str());
+				value = (unsigned char)atoi(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value = (unsigned char)atoi(typedPropertyAsCStr->m_data);
+					value = (unsigned char)atoi(*valueAsCStr);
 				}
 			}
 		}
@@ -153,27 +551,27 @@ unsigned char NamedProperties::GetValue(std::string const& keyName, unsigned cha
 float NamedProperties::GetValue(std::string const& keyName, float defaultValue) const
 {
 	float value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<float>* typedPropertyAsInt = dynamic_cast<TypedProperty<float>*>(mapIter->second);
-		if (typedPropertyAsInt)
+		float const* valueAsFloat = property->GetValuePointer<float>();
+		if (valueAsFloat)
 		{
-			value = typedPropertyAsInt->m_data;
+			value = *valueAsFloat;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value = (float)atof(typedPropertyAsStr->m_data.c_str());
+				value = (float)atof(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value = (float)atoi(typedPropertyAsCStr->m_data);
+					value = (float)atoi(*valueAsCStr);
 				}
 			}
 		}
@@ -184,20 +582,20 @@ float NamedProperties::GetValue(std::string const& keyName, float defaultValue)
 std::string NamedProperties::GetValue(std::string const& keyName, char const* defaultValue) const
 {
 	std::string value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-		if (typedPropertyAsCStr)
+		char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+		if (valueAsCStr)
 		{
-			value = typedPropertyAsCStr->m_data;
+			value = *valueAsCStr;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value = typedPropertyAsStr->m_data.c_str();
+				value = valueAsStr->c_str();
 			}
 		}
 	}
@@ -215,27 +613,27 @@ std::string NamedProperties::GetValue(std::string const& keyName, char const* de
 Rgba8 NamedProperties::GetValue(std::string const& keyName, Rgba8 const& defaultValue) const
 {
 	Rgba8 value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<Rgba8>* typedPropertyAsRgba = dynamic_cast<TypedProperty<Rgba8>*>(mapIter->second);
-		if (typedPropertyAsRgba)
+		Rgba8 const* valueAsRgba = property->GetValuePointer<Rgba8>();
+		if (valueAsRgba)
 		{
-			value = typedPropertyAsRgba->m_data;
+			value = *valueAsRgba;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value.SetFromText(typedPropertyAsStr->m_data.c_str());
+				value.SetFromText(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value.SetFromText(typedPropertyAsCStr->m_data);
+					value.SetFromText(*valueAsCStr);
 				}
 			}
 		}
@@ -254,27 +652,27 @@ Rgba8 NamedProperties::GetValue(std::string const& keyName, Rgba8 const& default
 Vec2 NamedProperties::GetValue(std::string const& keyName, Vec2 const& defaultValue) const
 {
 	Vec2 value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<Vec2>* typedPropertyAsVec2 = dynamic_cast<TypedProperty<Vec2>*>(mapIter->second);
-		if (typedPropertyAsVec2)
+		Vec2 const* valueAsVec2 = property->GetValuePointer<Vec2>();
+		if (valueAsVec2)
 		{
-			value = typedPropertyAsVec2->m_data;
+			value = *valueAsVec2;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value.SetFromText(typedPropertyAsStr->m_data.c_str());
+				value.SetFromText(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value.SetFromText(typedPropertyAsCStr->m_data);
+					value.SetFromText(*valueAsCStr);
 				}
 			}
 		}
@@ -293,30 +691,186 @@ Vec2 NamedProperties::GetValue(std::string const& keyName, Vec2 const& defaultVa
 IntVec2 NamedProperties::GetValue(std::string const& keyName, IntVec2 const& defaultValue) const
 {
 	IntVec2 value = defaultValue;
-	auto mapIter = m_properties.find(keyName);
-	if (mapIter != m_properties.end())
+	PropertyValue const* property = FindProperty(keyName);
+	if (property)
 	{
-		TypedProperty<IntVec2>* typedPropertyAsIntVec2 = dynamic_cast<TypedProperty<IntVec2>*>(mapIter->second);
-		if (typedPropertyAsIntVec2)
+		IntVec2 const* valueAsIntVec2 = property->GetValuePointer<IntVec2>();
+		if (valueAsIntVec2)
 		{
-			value = typedPropertyAsIntVec2->m_data;
+			value = *valueAsIntVec2;
 		}
 		else
 		{
-			TypedProperty<std::string>* typedPropertyAsStr = dynamic_cast<TypedProperty<std::string>*>(mapIter->second);
-			if (typedPropertyAsStr)
+			std::string const* valueAsStr = property->GetValuePointer<std::string>();
+			if (valueAsStr)
 			{
-				value.SetFromText(typedPropertyAsStr->m_data.c_str());
+				value.SetFromText(valueAsStr->c_str());
 			}
 			else
 			{
-				TypedProperty<char const*>* typedPropertyAsCStr = dynamic_cast<TypedProperty<char const*>*>(mapIter->second);
-				if (typedPropertyAsCStr)
+				char const* const* valueAsCStr = property->GetValuePointer<char const*>();
+				if (valueAsCStr)
 				{
-					value.SetFromText(typedPropertyAsCStr->m_data);
+					value.SetFromText(*valueAsCStr);
 				}
 			}
 		}
 	}
 	return value;
 }
+
+/*! \brief Returns the key of the property at the provided index
+*
+* Properties are in the order they were first set.
+* \param propertyIndex The index of the property, must be less than GetNumProperties
+* \return The key of the property at the provided index
+*
+*/
+HCIS const& NamedProperties::GetPropertyKey(int propertyIndex) const
+{
+	if (propertyIndex < m_numInlineProperties)
+	{
+		return m_inlinePropertyKeys[propertyIndex];
+	}
+	return m_overflowProperties.GetEntry(propertyIndex - m_numInlineProperties).m_key;
+}
+
+//! Returns the value of the property at the provided index, see GetPropertyKey
+PropertyValue const& NamedProperties::GetPropertyValue(int propertyIndex) const
+{
+	if (propertyIndex < m_numInlineProperties)
+	{
+		return m_inlinePropertyValues[propertyIndex];
+	}
+	return m_overflowProperties.GetEntry(propertyIndex - m_numInlineProperties).m_value;
+}
+
+/*! \brief Returns the value of the property with the provided key, or nullptr if no value has been set for the key
+*
+* The inline properties are searched linearly comparing precomputed key hashes first, which is faster than any map lookup for the handful of properties a NamedProperties usually holds. Only if they are all in use is the overflow map searched.
+* \param keyName The case-insensitive key of the property
+* \return The value of the property with the provided key, or nullptr if there is none
+*
+*/
+PropertyValue const* NamedProperties::FindProperty(std::string const& keyName) const
+{
+	unsigned int keyHash = HCIS::GetHashForText(keyName);
+	for (int propertyIndex = 0; propertyIndex < m_numInlineProperties; propertyIndex++)
+	{
+		HCIS const& propertyKey = m_inlinePropertyKeys[propertyIndex];
+		if (propertyKey.GetHash() == keyHash && !_stricmp(propertyKey.c_str(), keyName.c_str()))
+		{
+			return &m_inlinePropertyValues[propertyIndex];
+		}
+	}
+
+	if (m_overflowProperties.IsEmpty())
+	{
+		return nullptr;
+	}
+	return m_overflowProperties.Find(keyName);
+}
+
+PropertyValue* NamedProperties::FindProperty(std::string const& keyName)
+{
+	return const_cast<PropertyValue*>(static_cast<NamedProperties const*>(this)->FindProperty(keyName));
+}
+
+//! Adds a property without a value for the provided key, which must not have a property already
+PropertyValue* NamedProperties::AddProperty(std::string const& keyName)
+{
+	if (m_numInlineProperties < NUM_INLINE_PROPERTIES)
+	{
+		m_inlinePropertyKeys[m_numInlineProperties] = keyName;
+		m_numInlineProperties++;
+		return &m_inlinePropertyValues[m_numInlineProperties - 1];
+	}
+	return &m_overflowProperties[keyName];
+}
+
+//! Copies all properties of another NamedProperties into this one, overwriting the values of properties with the same keys
+void NamedProperties::AddProperties(NamedProperties const& propertiesToAdd)
+{
+	int numPropertiesToAdd = propertiesToAdd.GetNumProperties();
+	for (int propertyIndex = 0; propertyIndex < numPropertiesToAdd; propertyIndex++)
+	{
+		std::string keyName = propertiesToAdd.GetPropertyKey(propertyIndex).GetOriginalString();
+		PropertyValue* property = FindProperty(keyName);
+		if (!property)
+		{
+			property = AddProperty(keyName);
+		}
+		*property = propertiesToAdd.GetPropertyValue(propertyIndex);
+	}
+}
+
+//! Removes all properties, destroying their values
+void NamedProperties::Clear()
+{
+	for (int propertyIndex = 0; propertyIndex < NUM_INLINE_PROPERTIES; propertyIndex++)
+	{
+		m_inlinePropertyValues[propertyIndex].ClearValue();
+	}
+	m_numInlineProperties = 0;
+	m_overflowProperties.Clear();
+}
+
+/*! \brief Returns the number of heap allocations currently owned by this collection
+*
+* Counts the storage of the overflow map, if any properties have spilled into it, and every value too large to be stored inline. Memory owned by the values themselves, such as the buffer of a long std::string, is not counted.
+*
+*/
+int NamedProperties::GetNumHeapAllocations() const
+{
+	// The overflow map keeps its entries and its slots in two separate arrays
+	int numHeapAllocations = m_overflowProperties.IsEmpty() ? 0 : 2;
+	int numProperties = GetNumProperties();
+	for (int propertyIndex = 0; propertyIndex < numProperties; propertyIndex++)
+	{
+		PropertyTypeInfo const* typeInfo = GetPropertyValue(propertyIndex).m_typeInfo;
+		if (typeInfo && !typeInfo->m_isValueStoredInline)
+		{
+			numHeapAllocations++;
+		}
+	}
+	return numHeapAllocations;
+}
+
+PropertyValue::~PropertyValue()
+{
+	ClearValue();
+}
+
+PropertyValue::PropertyValue(PropertyValue const& copyFrom)
+{
+	if (copyFrom.m_typeInfo)
+	{
+		copyFrom.m_typeInfo->m_copyConstructValue(m_valueStorage, copyFrom.m_valueStorage);
+		m_typeInfo = copyFrom.m_typeInfo;
+	}
+}
+
+void PropertyValue::operator=(PropertyValue const& assignFrom)
+{
+	if (this == &assignFrom)
+	{
+		return;
+	}
+
+	ClearValue();
+	if (assignFrom.m_typeInfo)
+	{
+		assignFrom.m_typeInfo->m_copyConstructValue(m_valueStorage, assignFrom.m_valueStorage);
+		m_typeInfo = assignFrom.m_typeInfo;
+	}
+}
+
+//! Destroys the value, if there is one
+void PropertyValue::ClearValue()
+{
+	if (m_typeInfo)
+	{
+		m_typeInfo->m_destructValue(m_valueStorage);
+		m_typeInfo = nullptr;
+	}
+}
@@ -1,32 +1,145 @@
 #pragma once
 
 #include "Engine/Core/HashedCaseInsensitiveString.hpp"
+#include "Engine/Core/HCISMap.hpp"
 
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 
-#include <map>
+#include <cstddef>
+#include <new>
 #include <string>
-#include <typeinfo>
 
 
-class TypedPropertyBase
+class BufferParser;
+class BufferWriter;
+
+/*! \brief Operations for one type of value stored in a PropertyValue
+*
+* Every type gets exactly one PropertyTypeInfo (see GetPropertyTypeInfo), so the address of a value's PropertyTypeInfo identifies the type of its value and checking the type is a pointer comparison instead of a dynamic_cast.
+*
+*/
+struct PropertyTypeInfo
 {
 public:
-	virtual ~TypedPropertyBase() = default;
-	TypedPropertyBase() = default;
+	void (*m_copyConstructValue)(void* destinationStorage, void const* sourceStorage) = nullptr;
+	void (*m_destructValue)(void* storage) = nullptr;
+	//! Whether values of this type fit in the inline storage of a PropertyValue, if not each value is a separate heap allocation
+	bool m_isValueStoredInline = true;
 };
 
+//! Values of types that fit in this many bytes are stored inside the PropertyValue, larger values are allocated on the heap
+constexpr size_t NAMED_PROPERTY_INLINE_VALUE_SIZE = sizeof(std::string) > 32 ? sizeof(std::string) : 32;
+
+template<typename T>
+constexpr bool IsNamedPropertyValueStoredInline()
+{
+	return sizeof(T) <= NAMED_PROPERTY_INLINE_VALUE_SIZE && alignof(T) <= alignof(std::max_align_t);
+}
+
+//! \cond
+// Hides the per-type helpers from doxygen documentation
+template<typename T>
+void CopyConstructNamedPropertyValue(void* destinationStorage, void const* sourceStorage)
+{
+	if constexpr (IsNamedPropertyValueStoredInline<T>())
+	{
+		new (destinationStorage) T(*reinterpret_cast<T const*>(sourceStorage));
+	}
+	else
+	{
+		*reinterpret_cast<T**>(destinationStorage) = new T(**reinterpret_cast<T* const*>(sourceStorage));
+	}
+}
+
 template<typename T>
-class TypedProperty : public TypedPropertyBase
+void DestructNamedPropertyValue(void* storage)
 {
-	friend class NamedProperties;
+	if constexpr (IsNamedPropertyValueStoredInline<T>())
+	{
+		reinterpret_cast<T*>(storage)->~T();
+	}
+	else
+	{
+		delete *reinterpret_cast<T**>(storage);
+	}
+}
+//! \endcond
+
+/*! \brief Returns the PropertyTypeInfo for values of type T
+*
+* The PropertyTypeInfo is deliberately not const so that the linker cannot merge the infos of two types whose operations compile to identical code, which would make the types indistinguishable.
+*
+*/
+template<typename T>
+PropertyTypeInfo const* GetPropertyTypeInfo()
+{
+	static PropertyTypeInfo s_typeInfo = { &CopyConstructNamedPropertyValue<T>, &DestructNamedPropertyValue<T>, IsNamedPropertyValueStoredInline<T>() };
+	return &s_typeInfo;
+}
+
+/*! \brief A value of any copyable type
+*
+* Small values are stored inline so that setting them does not allocate, larger values are allocated on the heap and owned by the PropertyValue.
+*
+*/
+class PropertyValue
+{
+public:
+	~PropertyValue();
+	PropertyValue() = default;
+	PropertyValue(PropertyValue const& copyFrom);
+	void operator=(PropertyValue const& assignFrom);
+
+	template<typename T>
+	void SetValue(T const& value)
+	{
+		ClearValue();
+		PropertyTypeInfo const* typeInfo = GetPropertyTypeInfo<T>();
+		if constexpr (IsNamedPropertyValueStoredInline<T>())
+		{
+			new (m_valueStorage) T(value);
+		}
+		else
+		{
+			*reinterpret_cast<T**>(m_valueStorage) = new T(value);
+		}
+		m_typeInfo = typeInfo;
+	}
+
+	//! Returns a pointer to the value if it is of type T, nullptr otherwise
+	template<typename T>
+	T const* GetValuePointer() const
+	{
+		if (m_typeInfo != GetPropertyTypeInfo<T>())
+		{
+			return nullptr;
+		}
+		if constexpr (IsNamedPropertyValueStoredInline<T>())
+		{
+			return reinterpret_cast<T const*>(m_valueStorage);
+		}
+		else
+		{
+			return *reinterpret_cast<T* const*>(m_valueStorage);
+		}
+	}
+
+	void ClearValue();
 
-	T m_data;
+public:
+	PropertyTypeInfo const* m_typeInfo = nullptr;
+	alignas(std::max_align_t) unsigned char m_valueStorage[NAMED_PROPERTY_INLINE_VALUE_SIZE] = {};
 };
 
+/*! \brief A collection of values of any copyable type, looked up by case-insensitive keys
+*
+* The first NUM_INLINE_PROPERTIES properties are stored inside the NamedProperties object and searched linearly, so small collections such as event arguments can be built without allocating as long as their keys and values are small. Further properties spill into an HCISMap, so large collections such as the game config blackboard are still looked up in constant time.
+* Values are owned by the collection and destroyed with it, and copying a NamedProperties copies the values.
+*
+*/
 class NamedProperties
 {
 public:
@@ -34,6 +147,9 @@ public:
 	NamedProperties() = default;
 
 	void				PopulateFromXmlElementAttributes(XmlElement const& element);
+	bool				PopulateFromXmlFile(std::string const& xmlFilePath, bool useBinaryCache = true);
+	bool				AppendToBuffer(BufferWriter& bufferWriter) const;
+	bool				PopulateFromBuffer(BufferParser& bufferParser);
 	bool				GetValue(std::string const& keyName, bool defaultValue) const;
 	int					GetValue(std::string const& keyName, int defaultValue) const;
 	unsigned char		GetValue(std::string const& keyName, unsigned char defaultValue) const;
@@ -44,32 +160,55 @@ public:
 	IntVec2				GetValue(std::string const& keyName, IntVec2 const& defaultValue) const;
 
 	template<typename T>
-	T GetValue(std::string key, T defaultValue) const
+	T GetValue(std::string const& key, T defaultValue) const
 	{
-		auto mapIter = m_properties.find(key);
-		if (mapIter == m_properties.end())
+		PropertyValue const* property = FindProperty(key);
+		if (!property)
 		{
 			return defaultValue;
 		}
 
 		// There is a value stored for that key
-		TypedProperty<T>* typedProperty = dynamic_cast<TypedProperty<T>*>(mapIter->second);
-		if (!typedProperty)
+		T const* value = property->GetValuePointer<T>();
+		if (!value)
 		{
 			return defaultValue;
 		}
 
-		return typedProperty->m_data;
+		return *value;
 	}
-	
+
 	template<typename T>
-	void SetValue(std::string key, T value)
+	void SetValue(std::string const& key, T value)
 	{
-		TypedProperty<T>* typedProperty = new TypedProperty<T>();
-		typedProperty->m_data = value;
-		m_properties[HCIS(key)] = typedProperty;
+		PropertyValue* property = FindProperty(key);
+		if (!property)
+		{
+			property = AddProperty(key);
+		}
+		property->SetValue(value);
 	}
 
+	int					GetNumProperties() const { return m_numInlineProperties + m_overflowProperties.GetSize(); }
+	HCIS const&			GetPropertyKey(int propertyIndex) const;
+	PropertyValue const& GetPropertyValue(int propertyIndex) const;
+	PropertyValue const* FindProperty(std::string const& keyName) const;
+	void				AddProperties(NamedProperties const& propertiesToAdd);
+	void				Clear();
+	int					GetNumHeapAllocations() const;
+
+protected:
+	PropertyValue*		FindProperty(std::string const& keyName);
+	PropertyValue*		AddProperty(std::string const& keyName);
+
 public:
-	std::map<HCIS, TypedPropertyBase*> m_properties;
+	static constexpr int NUM_INLINE_PROPERTIES = 4;
+	//! Appended to the path of an XML file to get the path of its binary cache, see PopulateFromXmlFile
+	static constexpr char const* BINARY_CACHE_FILE_EXTENSION = ".cache";
+
+protected:
+	HCIS m_inlinePropertyKeys[NUM_INLINE_PROPERTIES];
+	PropertyValue m_inlinePropertyValues[NUM_INLINE_PROPERTIES];
+	int m_numInlineProperties = 0;
+	HCISMap<PropertyValue> m_overflowProperties;
 };
@@ -1,5 +1,11 @@
 #include "Engine/Core/NamedStrings.hpp"
 
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+
+#include <utility>
+#include <vector>
+
 
 /*! \brief Adds all attributes of the given XmlElement to the NamedStrings instance
 * 
@@ -17,6 +23,59 @@ void NamedStrings::PopulateFromXmlElementAttributes(XmlElement const& element)
 	}
 }
 
+/*! \brief Appends all key-value pairs to a buffer in a binary form that can be read back with PopulateFromBuffer
+*
+* \param bufferWriter The BufferWriter to append the key-value pairs to
+*
+*/
+void NamedStrings::AppendToBuffer(BufferWriter& bufferWriter) const
+{
+	bufferWriter.AppendUint32((uint32_t)m_keyValuePairs.GetSize());
+	for (auto const& keyValuePair : m_keyValuePairs)
+	{
+		bufferWriter.AppendStringAfter32BitLength(keyValuePair.m_key.GetOriginalString());
+		bufferWriter.AppendStringAfter32BitLength(keyValuePair.m_value);
+	}
+}
+
+/*! \brief Adds the key-value pairs from a buffer written by AppendToBuffer, overwriting the values of existing keys
+*
+* Every count and length is checked against the rest of the buffer before it is parsed, so a corrupt buffer such as a damaged cache file makes this return false rather than failing a GUARANTEE_OR_DIE.
+* \param bufferParser The BufferParser positioned at the start of the key-value pairs
+* \return A boolean indicating whether the key-value pairs were read, false if the buffer is truncated in which case no key-value pairs are added
+*
+*/
+bool NamedStrings::PopulateFromBuffer(BufferParser& bufferParser)
+{
+	if (bufferParser.GetRemainingSize() < 4)
+	{
+		return false;
+	}
+
+	// Every pair takes at least the 8 bytes of its two string lengths
+	uint32_t numKeyValuePairs = bufferParser.ParseUint32();
+	if (numKeyValuePairs > (uint32_t)bufferParser.GetRemainingSize() / 8)
+	{
+		return false;
+	}
+
+	std::vector<std::pair<std::string, std::string>> parsedKeyValuePairs(numKeyValuePairs);
+	for (uint32_t pairIndex = 0; pairIndex < numKeyValuePairs; pairIndex++)
+	{
+		if (!bufferParser.TryParseStringAfter32BitLength(parsedKeyValuePairs[pairIndex].first) || !bufferParser.TryParseStringAfter32BitLength(parsedKeyValuePairs[pairIndex].second))
+		{
+			return false;
+		}
+	}
+
+	m_keyValuePairs.Reserve(m_keyValuePairs.GetSize() + (int)numKeyValuePairs);
+	for (uint32_t pairIndex = 0; pairIndex < numKeyValuePairs; pairIndex++)
+	{
+		SetValue(parsedKeyValuePairs[pairIndex].first, parsedKeyValuePairs[pairIndex].second);
+	}
+	return true;
+}
+
 /*! \brief Sets the value for a given key
 * 
 * If no key with the keyName exists, a new key-value mapping is added. If the key already exists, updates the value for that key.
@@ -40,10 +99,10 @@ void NamedStrings::SetValue(std::string const& keyName, std::string const& newVa
 std::string NamedStrings::GetValue(std::string const& keyName, std::string const& defaultValue) const
 {
 	std::string value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value = mapIter->second;
+		value = *storedValue;
 	}
 	return value;
 }
@@ -59,14 +118,14 @@ std::string NamedStrings::GetValue(std::string const& keyName, std::string const
 bool NamedStrings::GetValue(std::string const& keyName, bool defaultValue) const
 {
 	bool value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		if (!strcmp((mapIter->second).c_str(), "true"))
+		if (!strcmp(storedValue->c_str(), "true"))
 		{
 			value = true;
 		}
-		else if (!strcmp((mapIter->second).c_str(), "false"))
+		else if (!strcmp(storedValue->c_str(), "false"))
 		{
 			value = false;
 		}
@@ -85,10 +144,10 @@ bool NamedStrings::GetValue(std::string const& keyName, bool defaultValue) const
 int NamedStrings::GetValue(std::string const& keyName, int defaultValue) const
 {
 	int value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value = atoi((mapIter->second).c_str());
+		value = atoi(storedValue->c_str());
 	}
 	return value;
 }
@@ -104,10 +163,10 @@ int NamedStrings::GetValue(std::string const& keyName, int defaultValue) const
 float NamedStrings::GetValue(std::string const& keyName, float defaultValue) const
 {
 	float value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value = static_cast<float>(atof((mapIter->second).c_str()));
+		value = static_cast<float>(atof(storedValue->c_str()));
 	}
 	return value;
 }
@@ -123,10 +182,10 @@ float NamedStrings::GetValue(std::string const& keyName, float defaultValue) con
 std::string NamedStrings::GetValue(std::string const& keyName, char const* defaultValue) const
 {
 	std::string value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value = mapIter->second;
+		value = *storedValue;
 	}
 	return value;
 }
@@ -142,10 +201,10 @@ std::string NamedStrings::GetValue(std::string const& keyName, char const* defau
 Rgba8 NamedStrings::GetValue(std::string const& keyName, Rgba8 const& defaultValue) const
 {
 	Rgba8 value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value.SetFromText((mapIter->second).c_str());
+		value.SetFromText(storedValue->c_str());
 	}
 	return value;
 }
@@ -161,10 +220,10 @@ Rgba8 NamedStrings::GetValue(std::string const& keyName, Rgba8 const& defaultVal
 Vec2 NamedStrings::GetValue(std::string const& keyName, Vec2 const& defaultValue) const
 {
 	Vec2 value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value.SetFromText((mapIter->second).c_str());
+		value.SetFromText(storedValue->c_str());
 	}
 	return value;
 }
@@ -180,10 +239,10 @@ Vec2 NamedStrings::GetValue(std::string const& keyName, Vec2 const& defaultValue
 IntVec2 NamedStrings::GetValue(std::string const& keyName, IntVec2 const& defaultValue) const
 {
 	IntVec2 value = defaultValue;
-	auto mapIter = m_keyValuePairs.find(keyName);
-	if (mapIter != m_keyValuePairs.end())
+	std::string const* storedValue = m_keyValuePairs.Find(keyName);
+	if (storedValue)
 	{
-		value.SetFromText((mapIter->second).c_str());
+		value.SetFromText(storedValue->c_str());
 	}
 	return value;
 }
@@ -1,15 +1,18 @@
 #pragma once
 
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/HCISMap.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 
-#include <map>
 #include <string>
 
 
+class BufferParser;
+class BufferWriter;
+
 /*! \brief A mapping of string-string key-value pairs
 * 
 * Although the class only offers a mapping of strings to strings, it provides convenience methods for retrieving values as different types.
@@ -26,6 +29,8 @@ public:
 	NamedStrings() = default;
 
 	void				PopulateFromXmlElementAttributes(XmlElement const& element);
+	void				AppendToBuffer(BufferWriter& bufferWriter) const;
+	bool				PopulateFromBuffer(BufferParser& bufferParser);
 	void				SetValue(std::string const& keyName, std::string const& newValue);
 	std::string			GetValue(std::string const& keyName, std::string const& defaultValue) const;
 	bool				GetValue(std::string const& keyName, bool defaultValue) const;
@@ -37,6 +42,6 @@ public:
 	IntVec2				GetValue(std::string const& keyName, IntVec2 const& defaultValue) const;
 
 private:
-	//! The map that stores key-value pairs in the form of strings (names) and strings (values)
-	std::map<std::string, std::string, cmpCaseInsensitive>		m_keyValuePairs;
+	//! The map that stores key-value pairs in the form of strings (names) and strings (values), keys are case-insensitive
+	HCISMap<std::string>										m_keyValuePairs;
 };
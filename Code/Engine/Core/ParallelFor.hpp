@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Engine/Core/JobSystem.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+//! \file ParallelFor.hpp
+
+//! \cond
+// Hides the internal job types from doxygen documentation
+struct ParallelForState
+{
+public:
+	ParallelForState(int rangeBegin, int rangeEnd, int grainSize)
+		: m_rangeBegin(rangeBegin)
+		, m_grainSize(grainSize)
+		, m_numRemainingIndexes(rangeEnd - rangeBegin)
+	{
+	}
+
+public:
+	int m_rangeBegin = 0;
+	int m_grainSize = 1;
+	std::atomic<int> m_numRemainingIndexes = 0;
+};
+
+template<typename LeafFunc>
+void ExecuteParallelForRange(JobSystem& jobSystem, ParallelForState& state, int beginIndex, int endIndex, LeafFunc const& leafFunc);
+
+template<typename LeafFunc>
+class ParallelForJob : public Job
+{
+public:
+	ParallelForJob(JobSystem& jobSystem, ParallelForState& state, int beginIndex, int endIndex, LeafFunc const& leafFunc)
+		: m_jobSystem(jobSystem)
+		, m_state(state)
+		, m_beginIndex(beginIndex)
+		, m_endIndex(endIndex)
+		, m_leafFunc(leafFunc)
+	{
+		m_isRetrievable = false;
+	}
+
+	virtual void Execute() override
+	{
+		ExecuteParallelForRange(m_jobSystem, m_state, m_beginIndex, m_endIndex, m_leafFunc);
+	}
+
+public:
+	JobSystem& m_jobSystem;
+	ParallelForState& m_state;
+	int m_beginIndex = 0;
+	int m_endIndex = 0;
+	LeafFunc const& m_leafFunc;
+};
+
+/* Splits the range in half at a multiple of the grain size and queues the upper half until the range fits in a single grain, then runs the leaf.
+* Queued halves land on the current worker's deque (or the global queue for non-worker threads) where idle workers can steal them, so work is only spread to threads that are actually free.
+* Leaves always start at a multiple of the grain size from the start of the full range, so leaf indexes are stable regardless of which thread runs them.
+*/
+template<typename LeafFunc>
+void ExecuteParallelForRange(JobSystem& jobSystem, ParallelForState& state, int beginIndex, int endIndex, LeafFunc const& leafFunc)
+{
+	while (endIndex - beginIndex > state.m_grainSize)
+	{
+		int numGrains = (endIndex - beginIndex + state.m_grainSize - 1) / state.m_grainSize;
+		int splitIndex = beginIndex + (numGrains / 2) * state.m_grainSize;
+		jobSystem.QueueJob(jobSystem.CreateJob<ParallelForJob<LeafFunc>>(jobSystem, state, splitIndex, endIndex, leafFunc));
+		endIndex = splitIndex;
+	}
+
+	leafFunc(beginIndex, endIndex);
+
+	// The state lives on the calling thread's stack and must not be touched after this
+	state.m_numRemainingIndexes -= endIndex - beginIndex;
+}
+
+template<typename LeafFunc>
+void RunParallelForLeaves(JobSystem& jobSystem, int beginIndex, int endIndex, int grainSize, LeafFunc const& leafFunc)
+{
+	if (endIndex <= beginIndex)
+	{
+		return;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	ParallelForState state(beginIndex, endIndex, grainSize);
+	ExecuteParallelForRange(jobSystem, state, beginIndex, endIndex, leafFunc);
+
+	// The calling thread helps with the remaining leaves instead of blocking
+	while (state.m_numRemainingIndexes > 0)
+	{
+		if (!jobSystem.ExecuteQueuedJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+//! \endcond
+
+/*! \brief Calls func(index) for every index in [beginIndex, endIndex) using the job system's workers and the calling thread
+*
+* The range is split recursively into grains of grainSize indexes. Split-off halves are queued as jobs that idle workers can steal, while the calling thread keeps working on the lower half and then helps execute queued jobs until every index has been processed.
+* Returns only once func has been called for every index. func must be safe to call concurrently for different indexes.
+* \param jobSystem The JobSystem whose workers should be used
+* \param beginIndex The first index of the range
+* \param endIndex One past the last index of the range
+* \param grainSize The maximum number of indexes processed by a single job. Larger grains reduce scheduling overhead, smaller grains balance load better
+* \param func A callable taking an int index
+*
+*/
+template<typename Func>
+void ParallelFor(JobSystem& jobSystem, int beginIndex, int endIndex, int grainSize, Func const& func)
+{
+	auto leafFunc = [&func](int leafBeginIndex, int leafEndIndex)
+	{
+		for (int index = leafBeginIndex; index < leafEndIndex; index++)
+		{
+			func(index);
+		}
+	};
+	RunParallelForLeaves(jobSystem, beginIndex, endIndex, grainSize, leafFunc);
+}
+
+/*! \brief Reduces the range [beginIndex, endIndex) to a single value using the job system's workers and the calling thread
+*
+* Each grain of grainSize indexes is accumulated into its own partial result starting from identity, then the partial results are combined in index order on the calling thread. The result is therefore deterministic for a given grainSize even for non-associative operations such as floating point addition.
+* T must be default constructible and copy assignable.
+* \param jobSystem The JobSystem whose workers should be used
+* \param beginIndex The first index of the range
+* \param endIndex One past the last index of the range
+* \param grainSize The number of indexes accumulated into each partial result
+* \param identity The initial value of every partial result (0 for sums, FLT_MAX for minimums, etc.)
+* \param accumulateFunc A callable taking (T& accumulator, int index) that folds an index into the accumulator
+* \param combineFunc A callable taking (T const&, T const&) and returning the combination of two partial results
+* \return The combination of all partial results, or identity if the range is empty
+*
+*/
+template<typename T, typename AccumulateFunc, typename CombineFunc>
+T ParallelReduce(JobSystem& jobSystem, int beginIndex, int endIndex, int grainSize, T const& identity, AccumulateFunc const& accumulateFunc, CombineFunc const& combineFunc)
+{
+	if (endIndex <= beginIndex)
+	{
+		return identity;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	int numGrains = (endIndex - beginIndex + grainSize - 1) / grainSize;
+	// Not a std::vector, since std::vector<bool> packs its elements into shared bits that cannot be written from different threads
+	std::unique_ptr<T[]> partialResults(new T[numGrains]);
+
+	auto leafFunc = [&](int leafBeginIndex, int leafEndIndex)
+	{
+		// Accumulated locally and stored once, so that leaves on different threads do not keep writing to neighboring partial results
+		T partialResult = identity;
+		for (int index = leafBeginIndex; index < leafEndIndex; index++)
+		{
+			accumulateFunc(partialResult, index);
+		}
+		partialResults[(leafBeginIndex - beginIndex) / grainSize] = partialResult;
+	};
+	RunParallelForLeaves(jobSystem, beginIndex, endIndex, grainSize, leafFunc);
+
+	T result = partialResults[0];
+	for (int grainIndex = 1; grainIndex < numGrains; grainIndex++)
+	{
+		result = combineFunc(result, partialResults[grainIndex]);
+	}
+	return result;
+}
@@ -0,0 +1,167 @@
+#include "Engine/Core/StringPool.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/HashedCaseInsensitiveString.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+#include <cstring>
+#include <mutex>
+
+
+StringPool::~StringPool()
+{
+	for (int pageIndex = 0; pageIndex < MAX_ENTRY_PAGES; pageIndex++)
+	{
+		delete[] m_entryPages[pageIndex].load();
+	}
+	for (int blockIndex = 0; blockIndex < static_cast<int>(m_textBlocks.size()); blockIndex++)
+	{
+		delete[] m_textBlocks[blockIndex];
+	}
+}
+
+StringPool::StringPool()
+{
+	StringID emptyStringID = Intern("");
+	GUARANTEE_OR_DIE(emptyStringID == STRINGID_EMPTY, "The empty string must be the first string interned");
+}
+
+/*! \brief Returns the StringPool shared by the whole process
+*
+* The pool is created the first time it is used, so it can be used by objects constructed during static initialization such as g_gameConfigBlackboard.
+*
+*/
+StringPool& StringPool::GetInstance()
+{
+	static StringPool s_stringPool;
+	return s_stringPool;
+}
+
+/*! \brief Returns the ID of the provided text, interning it if this is the first time it has been seen
+*
+* Interning text that is already in the pool only takes a shared lock, so threads interning known strings do not block each other.
+* \param text The text to intern, copied into the pool if it is new
+* \return The StringID for the text
+*
+*/
+StringID StringPool::Intern(std::string_view text)
+{
+	{
+		std::shared_lock<std::shared_mutex> readLock(m_mutex);
+		auto idIter = m_idsByText.find(text);
+		if (idIter != m_idsByText.end())
+		{
+			return idIter->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> writeLock(m_mutex);
+
+	// Another thread may have interned the text between the two locks
+	auto idIter = m_idsByText.find(text);
+	if (idIter != m_idsByText.end())
+	{
+		return idIter->second;
+	}
+
+	StringID newID = static_cast<StringID>(m_numEntries.load());
+	int pageIndex = static_cast<int>(newID / NUM_ENTRIES_PER_PAGE);
+	GUARANTEE_OR_DIE(pageIndex < MAX_ENTRY_PAGES, "StringPool is full");
+	if (!m_entryPages[pageIndex].load())
+	{
+		m_entryPages[pageIndex] = new Entry[NUM_ENTRIES_PER_PAGE];
+	}
+
+	Entry& newEntry = m_entryPages[pageIndex].load()[newID % NUM_ENTRIES_PER_PAGE];
+	newEntry.m_text = StoreText(text);
+	newEntry.m_length = static_cast<unsigned int>(text.size());
+	newEntry.m_caseInsensitiveHash = HCIS::GetHashForText(text);
+
+	std::string_view storedText(newEntry.m_text, text.size());
+	auto caseInsensitiveIDIter = m_caseInsensitiveIDsByText.find(storedText);
+	if (caseInsensitiveIDIter == m_caseInsensitiveIDsByText.end())
+	{
+		newEntry.m_caseInsensitiveID = newID;
+		m_caseInsensitiveIDsByText[storedText] = newID;
+	}
+	else
+	{
+		newEntry.m_caseInsensitiveID = caseInsensitiveIDIter->second;
+	}
+
+	m_idsByText[storedText] = newID;
+	m_numEntries = static_cast<int>(newID) + 1;
+	return newID;
+}
+
+//! Returns the null-terminated text of an interned string, valid for the lifetime of the process
+char const* StringPool::GetText(StringID stringID) const
+{
+	return GetEntry(stringID).m_text;
+}
+
+unsigned int StringPool::GetLength(StringID stringID) const
+{
+	return GetEntry(stringID).m_length;
+}
+
+//! Returns the ID of the first interned string that is equal to this one ignoring case. Two strings are equal ignoring case exactly when their case-insensitive IDs are equal
+StringID StringPool::GetCaseInsensitiveID(StringID stringID) const
+{
+	return GetEntry(stringID).m_caseInsensitiveID;
+}
+
+//! Returns HashedCaseInsensitiveString::GetHashForText for the interned string, computed once when it was interned
+unsigned int StringPool::GetCaseInsensitiveHash(StringID stringID) const
+{
+	return GetEntry(stringID).m_caseInsensitiveHash;
+}
+
+int StringPool::GetNumStrings() const
+{
+	return m_numEntries.load();
+}
+
+StringPool::Entry const& StringPool::GetEntry(StringID stringID) const
+{
+	Entry const* entryPage = m_entryPages[stringID / NUM_ENTRIES_PER_PAGE].load(std::memory_order_acquire);
+	return entryPage[stringID % NUM_ENTRIES_PER_PAGE];
+}
+
+// Copies the text into the current text block followed by a null terminator, starting a new block if it does not fit. Must be called with m_mutex locked for writing
+char const* StringPool::StoreText(std::string_view text)
+{
+	size_t numBytes = text.size() + 1;
+	char* storedText = nullptr;
+	if (numBytes > TEXT_BLOCK_SIZE / 4)
+	{
+		// Long strings get a block of their own so they do not waste the rest of the current block
+		storedText = new char[numBytes];
+		m_textBlocks.push_back(storedText);
+	}
+	else
+	{
+		if (m_numBytesUsedInTextBlock + numBytes > TEXT_BLOCK_SIZE)
+		{
+			m_currentTextBlock = new char[TEXT_BLOCK_SIZE];
+			m_textBlocks.push_back(m_currentTextBlock);
+			m_numBytesUsedInTextBlock = 0;
+		}
+		storedText = m_currentTextBlock + m_numBytesUsedInTextBlock;
+		m_numBytesUsedInTextBlock += numBytes;
+	}
+
+	memcpy(storedText, text.data(), text.size());
+	storedText[text.size()] = '\0';
+	return storedText;
+}
+
+size_t StringPool::CaseInsensitiveHasher::operator()(std::string_view text) const
+{
+	return HCIS::GetHashForText(text);
+}
+
+bool StringPool::CaseInsensitiveEquals::operator()(std::string_view textA, std::string_view textB) const
+{
+	return CompareCaseInsensitive(textA, textB) == 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+//! Compact identifier of a string interned in the StringPool. Two StringIDs are equal exactly when their strings are equal
+typedef unsigned int StringID;
+//! The empty string is always interned first, so default constructed IDs refer to it
+constexpr StringID STRINGID_EMPTY = 0;
+
+/*! \brief A process-wide, thread-safe pool of interned strings
+*
+* Every distinct string is stored once and identified by a 32-bit StringID, so strings that are used over and over (property keys, event names, XML attribute names) share their storage and compare as integers.
+* Each interned string also knows the ID of its case-insensitive equivalent, which is the ID of the first spelling of it that was interned, so case-insensitive comparisons are integer comparisons as well.
+* Interned strings are never freed and never move, so the text returned for an ID stays valid for the lifetime of the process. Looking up the text of an ID does not lock.
+*
+*/
+class StringPool
+{
+	struct Entry
+	{
+	public:
+		char const* m_text = nullptr;
+		unsigned int m_length = 0;
+		unsigned int m_caseInsensitiveHash = 0;
+		StringID m_caseInsensitiveID = STRINGID_EMPTY;
+	};
+
+	struct CaseInsensitiveHasher
+	{
+		size_t operator()(std::string_view text) const;
+	};
+	struct CaseInsensitiveEquals
+	{
+		bool operator()(std::string_view textA, std::string_view textB) const;
+	};
+
+public:
+	~StringPool();
+	StringPool();
+	StringPool(StringPool const& copyFrom) = delete;
+	void operator=(StringPool const& assignFrom) = delete;
+
+	static StringPool& GetInstance();
+
+	StringID Intern(std::string_view text);
+	char const* GetText(StringID stringID) const;
+	unsigned int GetLength(StringID stringID) const;
+	StringID GetCaseInsensitiveID(StringID stringID) const;
+	unsigned int GetCaseInsensitiveHash(StringID stringID) const;
+	int GetNumStrings() const;
+
+protected:
+	Entry const& GetEntry(StringID stringID) const;
+	char const* StoreText(std::string_view text);
+
+protected:
+	//! Entries are allocated in pages that never move, so entries can be read without locking while other threads intern new strings
+	static constexpr int NUM_ENTRIES_PER_PAGE = 4096;
+	static constexpr int MAX_ENTRY_PAGES = 4096;
+	static constexpr size_t TEXT_BLOCK_SIZE = 64 * 1024;
+
+	mutable std::shared_mutex m_mutex;
+	std::unordered_map<std::string_view, StringID> m_idsByText;
+	std::unordered_map<std::string_view, StringID, CaseInsensitiveHasher, CaseInsensitiveEquals> m_caseInsensitiveIDsByText;
+	std::atomic<Entry*> m_entryPages[MAX_ENTRY_PAGES] = {};
+	std::atomic<int> m_numEntries = 0;
+
+	std::vector<char*> m_textBlocks;
+	char* m_currentTextBlock = nullptr;
+	size_t m_numBytesUsedInTextBlock = TEXT_BLOCK_SIZE;
+};
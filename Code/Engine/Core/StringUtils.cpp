@@ -1,6 +1,11 @@
 #include "Engine/Core/StringUtils.hpp"
 #include <stdarg.h>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define STRINGUTILS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 
 //-----------------------------------------------------------------------------------------------
 constexpr int STRINGF_STACK_LOCAL_TEMP_LENGTH = 2048;
@@ -154,3 +159,61 @@ void StripString(std::string& stringToStrip, char tokenToStripOff)
 		}
 	}
 }
+
+
+#if defined(STRINGUTILS_USE_SSE2)
+//-----------------------------------------------------------------------------------------------
+// Lowercases the ASCII letters in 16 characters at once. Bytes outside 'A'-'Z', including every non-ASCII byte (negative as a signed char), are left unchanged
+static __m128i LowercaseASCII16(__m128i characters)
+{
+	__m128i isUpperCase = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8('Z' + 1)));
+	return _mm_add_epi8(characters, _mm_and_si128(isUpperCase, _mm_set1_epi8('a' - 'A')));
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Compares two strings ignoring the case of ASCII letters, without allocating. Returns a negative value if stringA sorts before stringB, 0 if they are equal and a positive value otherwise.
+// Orders strings the same way as comparing their lowercase copies with std::string::operator< did. 16 characters are compared at a time where SSE2 is available.
+int CompareCaseInsensitive(std::string_view stringA, std::string_view stringB)
+{
+	size_t commonLength = stringA.size() < stringB.size() ? stringA.size() : stringB.size();
+	size_t characterIndex = 0;
+
+#if defined(STRINGUTILS_USE_SSE2)
+	for (; characterIndex + 16 <= commonLength; characterIndex += 16)
+	{
+		__m128i lowerCaseA = LowercaseASCII16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(stringA.data() + characterIndex)));
+		__m128i lowerCaseB = LowercaseASCII16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(stringB.data() + characterIndex)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(lowerCaseA, lowerCaseB)) != 0xFFFF)
+		{
+			// The scalar loop below finds the differing character within these 16
+			break;
+		}
+	}
+#endif
+
+	for (; characterIndex < commonLength; characterIndex++)
+	{
+		unsigned char characterA = static_cast<unsigned char>(stringA[characterIndex]);
+		unsigned char characterB = static_cast<unsigned char>(stringB[characterIndex]);
+		if (characterA >= 'A' && characterA <= 'Z')
+		{
+			characterA += 'a' - 'A';
+		}
+		if (characterB >= 'A' && characterB <= 'Z')
+		{
+			characterB += 'a' - 'A';
+		}
+		if (characterA != characterB)
+		{
+			return characterA < characterB ? -1 : 1;
+		}
+	}
+
+	if (stringA.size() == stringB.size())
+	{
+		return 0;
+	}
+	return stringA.size() < stringB.size() ? -1 : 1;
+}
@@ -1,6 +1,7 @@
 #pragma once
 //-----------------------------------------------------------------------------------------------
 #include <string>
+#include <string_view>
 #include <vector>
 
 typedef std::vector<std::string> Strings;
@@ -13,3 +14,4 @@ int SplitStringOnDelimiter(Strings& out_splitStrings, std::string const& origina
 int SplitStringOnDelimiter(Strings& out_splitStrings, std::string const& originalString, char delimiterToSplitOn, char characterToTokenizeOn, bool removeCharacterToTokenizeOn = true);
 void TrimString(std::string& stringToTrim);
 void StripString(std::string& stringToStrip, char tokenToStripOff);
+int CompareCaseInsensitive(std::string_view stringA, std::string_view stringB);
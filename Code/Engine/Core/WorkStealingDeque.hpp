@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+/*! \brief A lock-free Chase-Lev work-stealing deque
+*
+* The owning thread pushes and pops items at the bottom of the deque (LIFO) while any other thread can steal items from the top (FIFO). Push and Pop must only be called by the owning thread, Steal can be called from any thread.
+* The ring buffer grows when full. Buffers that have been replaced are kept alive until the deque is destroyed since a concurrent thief might still be reading from them.
+* T must be a pointer type, nullptr is returned when no item could be popped or stolen.
+*
+*/
+template<typename T>
+class WorkStealingDeque
+{
+	struct RingBuffer
+	{
+	public:
+		~RingBuffer() { delete[] m_items; }
+		explicit RingBuffer(int64_t capacity)
+			: m_capacity(capacity)
+			, m_mask(capacity - 1)
+			, m_items(new std::atomic<T>[static_cast<size_t>(capacity)])
+		{
+		}
+
+		T Get(int64_t index) const { return m_items[index & m_mask].load(std::memory_order_relaxed); }
+		void Put(int64_t index, T item) { m_items[index & m_mask].store(item, std::memory_order_relaxed); }
+
+		RingBuffer* Grow(int64_t bottom, int64_t top) const
+		{
+			RingBuffer* grownBuffer = new RingBuffer(m_capacity * 2);
+			for (int64_t index = top; index < bottom; index++)
+			{
+				grownBuffer->Put(index, Get(index));
+			}
+			return grownBuffer;
+		}
+
+	public:
+		int64_t m_capacity = 0;
+		int64_t m_mask = 0;
+		std::atomic<T>* m_items = nullptr;
+	};
+
+public:
+	~WorkStealingDeque()
+	{
+		delete m_buffer.load(std::memory_order_relaxed);
+		for (int bufferIndex = 0; bufferIndex < (int)m_retiredBuffers.size(); bufferIndex++)
+		{
+			delete m_retiredBuffers[bufferIndex];
+		}
+	}
+
+	//! Initial capacity must be a power of two
+	explicit WorkStealingDeque(int64_t initialCapacity = 256)
+		: m_buffer(new RingBuffer(initialCapacity))
+	{
+	}
+
+	WorkStealingDeque(WorkStealingDeque const& copyFrom) = delete;
+	void operator=(WorkStealingDeque const& assignFrom) = delete;
+
+	void Push(T item)
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		int64_t top = m_top.load(std::memory_order_acquire);
+		RingBuffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+		if (bottom - top > buffer->m_capacity - 1)
+		{
+			m_retiredBuffers.push_back(buffer);
+			buffer = buffer->Grow(bottom, top);
+			m_buffer.store(buffer, std::memory_order_release);
+		}
+
+		buffer->Put(bottom, item);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	T Pop()
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		RingBuffer* buffer = m_buffer.load(std::memory_order_relaxed);
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Deque was already empty
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T item = buffer->Get(bottom);
+		if (top == bottom)
+		{
+			// Last item in the deque, race against thieves for it
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return item;
+	}
+
+	T Steal()
+	{
+		int64_t top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+
+		RingBuffer* buffer = m_buffer.load(std::memory_order_acquire);
+		T item = buffer->Get(top);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			// Lost the race to another thief or the owner
+			return nullptr;
+		}
+
+		return item;
+	}
+
+	//! Approximate number of items in the deque, exact only when called from the owning thread with no concurrent thieves
+	int GetSize() const
+	{
+		int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		int64_t top = m_top.load(std::memory_order_relaxed);
+		return bottom > top ? (int)(bottom - top) : 0;
+	}
+
+	bool IsEmpty() const { return GetSize() == 0; }
+
+private:
+	alignas(64) std::atomic<int64_t> m_top = 0;
+	alignas(64) std::atomic<int64_t> m_bottom = 0;
+	std::atomic<RingBuffer*> m_buffer = nullptr;
+	std::vector<RingBuffer*> m_retiredBuffers;
+};
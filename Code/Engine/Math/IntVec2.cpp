@@ -183,12 +183,6 @@ void IntVec2::RotateMinus90Degrees()
 	x = tempY;
 }
 
-void IntVec2::operator=(const IntVec2& copyFrom)
-{
-	x = copyFrom.x;
-	y = copyFrom.y;
-}
-
 void IntVec2::operator+=(const IntVec2& intVecToAdd)
 {
 	x += intVecToAdd.x;
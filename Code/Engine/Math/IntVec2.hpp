@@ -44,7 +44,7 @@ public:
 	void			Rotate90Degrees();
 	void			RotateMinus90Degrees();
 
-	void			operator=(const IntVec2& copyFrom);
+	IntVec2&		operator=(const IntVec2& copyFrom) = default;
 	void			operator+=(const IntVec2& intVecToAdd);
 	void			operator-=(const IntVec2& intVecToSubtract);
 	void			operator*=(int uniformScale);
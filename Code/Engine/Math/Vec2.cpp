@@ -8,13 +8,6 @@
 
 #include <math.h>
 
-Vec2::Vec2( const Vec2& copy )
-	: x( copy.x )
-	, y( copy.y )
-{
-
-}
-
 Vec2::Vec2( float initialX, float initialY )
 	: x( initialX )
 	, y( initialY )
@@ -91,12 +84,6 @@ void Vec2::operator/=( const float uniformDivisor )
 	y /= uniformDivisor;
 }
 
-void Vec2::operator=( const Vec2& copyFrom )
-{
-	x = copyFrom.x;
-	y = copyFrom.y;
-}
-
 const Vec2 operator*( float uniformScale, const Vec2& vecToScale )
 {
 	return Vec2( vecToScale.x * uniformScale, vecToScale.y * uniformScale );
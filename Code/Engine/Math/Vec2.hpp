@@ -11,7 +11,7 @@ public:
 public:
 	~Vec2() = default;
 	Vec2() = default;
-	Vec2( Vec2 const& copyFrom );
+	Vec2( Vec2 const& copyFrom ) = default;
 	explicit Vec2( float initialX, float initialY );
 
 	static Vec2 const MakeFromPolarRadians(float orientationRadians, float length = 1.f);
@@ -58,7 +58,7 @@ public:
 	void			operator-=(Vec2 const& vecToSubtract);
 	void			operator*=(float uniformScale);
 	void			operator/=(float uniformDivisor);
-	void			operator=(Vec2 const& copyFrom);
+	Vec2&			operator=(Vec2 const& copyFrom) = default;
 
 	Vec3 const		ToVec3(float z = 0.f) const;
 
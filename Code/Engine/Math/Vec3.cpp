@@ -7,14 +7,6 @@
 
 #include <math.h>
 
-Vec3::Vec3(const Vec3& copyFrom)
-	: x(copyFrom.x)
-	, y(copyFrom.y)
-	, z(copyFrom.z)
-{
-
-}
-
 Vec3::Vec3(float initialX, float initialY, float initialZ)
 	: x(initialX)
 	, y(initialY)
@@ -126,13 +118,6 @@ void Vec3::operator/=(const float uniformDivisor)
 	z /= uniformDivisor;
 }
 
-void Vec3::operator=(const Vec3& copyFrom)
-{
-	x = copyFrom.x;
-	y = copyFrom.y;
-	z = copyFrom.z;
-}
-
 const Vec3 operator*(float uniformScale, const Vec3 vecToScale)
 {
 	return Vec3(vecToScale.x * uniformScale, vecToScale.y * uniformScale, vecToScale.z * uniformScale);
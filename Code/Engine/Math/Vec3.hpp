@@ -10,9 +10,9 @@ public:
 	float z = 0.f;
 
 public:
-	~Vec3() {}
-	Vec3() {}
-	Vec3(const Vec3& copyFrom);
+	~Vec3() = default;
+	Vec3() = default;
+	Vec3(const Vec3& copyFrom) = default;
 	explicit Vec3(float initialX, float initialY, float initialZ);
 
 	static Vec3 const	MakeFromPolarRadians(float latitudeRadians, float longitudeRadians, float length = 1.f);
@@ -78,7 +78,7 @@ public:
 	void			operator*=(const Vec3& vecToMultiply);
 	void			operator*=(const float uniformScale);
 	void			operator/=(const float uniformDivisor);
-	void			operator=(const Vec3& copyFrom);
+	Vec3&			operator=(const Vec3& copyFrom) = default;
 
 
 	friend const Vec3 operator*(float uniformScale, const Vec3& vecToScale);
@@ -12,6 +12,13 @@
 
 Window* Window::s_mainWindow = nullptr;
 
+// Hashed at compile time since these are fired for every input message
+static constexpr EventID EVENTID_QUIT("Quit");
+static constexpr EventID EVENTID_WM_CHAR("WM_CHAR");
+static constexpr EventID EVENTID_WM_KEYDOWN("WM_KEYDOWN");
+static constexpr EventID EVENTID_WM_KEYUP("WM_KEYUP");
+static constexpr EventID EVENTID_WM_MOUSEWHEEL("WM_MOUSEWHEEL");
+
 
 LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessageCode, WPARAM wParam, LPARAM lParam)
 {
@@ -26,7 +33,7 @@ LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessa
 	{
 		case WM_CLOSE:
 		{
-			FireEvent("Quit");
+			FireEvent(EVENTID_QUIT);
 			return 0;
 		}
 
@@ -34,7 +41,7 @@ LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessa
 		{
 			EventArgs charEventArgs;
 			charEventArgs.SetValue("KeyCode", Stringf("%d", (unsigned char)wParam));
-			FireEvent("WM_CHAR", charEventArgs);
+			FireEvent(EVENTID_WM_CHAR, charEventArgs);
 			break;
 		}
 
@@ -42,7 +49,7 @@ LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessa
 		{
 			EventArgs keyDownEventArgs;
 			keyDownEventArgs.SetValue("KeyCode", Stringf("%d", (unsigned char)wParam));
-			FireEvent("WM_KEYDOWN", keyDownEventArgs);
+			FireEvent(EVENTID_WM_KEYDOWN, keyDownEventArgs);
 			break;
 		}
 
@@ -50,7 +57,7 @@ LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessa
 		{
 			EventArgs keyUpEventArgs;
 			keyUpEventArgs.SetValue("KeyCode", Stringf("%d", (unsigned char)wParam));
-			FireEvent("WM_KEYUP", keyUpEventArgs);
+			FireEvent(EVENTID_WM_KEYUP, keyUpEventArgs);
 			break;
 		}
 
@@ -87,7 +94,7 @@ LRESULT CALLBACK WindowsMessageHandlingProcedure(HWND windowHandle, UINT wmMessa
 			int zDelta = (int)GET_WHEEL_DELTA_WPARAM(wParam);
 			EventArgs args;
 			args.SetValue("ScrollValue", Stringf("%d", zDelta));
-			FireEvent("WM_MOUSEWHEEL", args);
+			FireEvent(EVENTID_WM_MOUSEWHEEL, args);
 			break;
 		}
 